@@ -0,0 +1,294 @@
+// ALU dispatch benchmark
+// Compares the original mnemonic string-compare execution path against the
+// OpId handler table on the same instruction stream.
+//
+// Usage: alu_dispatch_bench [passes]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include "alu.h"
+
+static int16_t sign_extend(uint16_t val, int bits) {
+    int16_t mask = 1 << (bits - 1);
+    return (val ^ mask) - mask;
+}
+
+// Reference: ALU::execute as it was before the handler table (string compares)
+static void legacyExecute(const DecodedInstruction& d, Registers& regs, Memory& mem, uint16_t& pc, bool& halted) {
+    const std::string& m = d.mnemonic;
+
+    switch (d.format) {
+        case FORMAT_R: {
+            uint16_t rs1_val = regs.get(d.rs1);
+            uint16_t rs2_val = regs.get(d.rs2);
+            uint16_t result = 0;
+
+            if (m == "ADD") result = rs1_val + rs2_val;
+            else if (m == "SUB") result = rs1_val - rs2_val;
+            else if (m == "AND") result = rs1_val & rs2_val;
+            else if (m == "OR")  result = rs1_val | rs2_val;
+            else if (m == "XOR") result = rs1_val ^ rs2_val;
+            else if (m == "SLT") result = int16_t(rs1_val) < int16_t(rs2_val) ? 1 : 0;
+            else if (m == "SLTU") result = rs1_val < rs2_val ? 1 : 0;
+            else if (m == "SLL") result = rs1_val << (rs2_val & 0xF);
+            else if (m == "SRL") result = rs1_val >> (rs2_val & 0xF);
+            else if (m == "SRA") result = int16_t(rs1_val) >> (rs2_val & 0xF);
+            else if (m == "MV")  result = rs2_val;
+            else if (m == "JR") {
+                pc = regs.get(d.rd);
+                return;
+            }
+            else if (m == "JALR") {
+                uint16_t ret_addr = pc;
+                pc = regs.get(d.rs2);
+                regs.set(d.rd, ret_addr);
+                return;
+            }
+
+            regs.set(d.rd, result);
+            break;
+        }
+
+        case FORMAT_I: {
+            uint16_t rs1_val = regs.get(d.rs1);
+            int16_t imm = d.imm;
+            uint16_t result = 0;
+
+            if (m == "ADDI") result = rs1_val + imm;
+            else if (m == "LI") result = imm;
+            else if (m == "SLTI") result = int16_t(rs1_val) < imm ? 1 : 0;
+            else if (m == "SLTUI") result = rs1_val < uint16_t(imm) ? 1 : 0;
+            else if (m == "SLLI") result = rs1_val << (imm & 0xF);
+            else if (m == "SRLI") result = rs1_val >> (imm & 0xF);
+            else if (m == "SRAI") result = int16_t(rs1_val) >> (imm & 0xF);
+            else if (m == "ORI") result = rs1_val | imm;
+            else if (m == "ANDI") result = rs1_val & imm;
+            else if (m == "XORI") result = rs1_val ^ imm;
+
+            regs.set(d.rd, result);
+            break;
+        }
+
+        case FORMAT_S: {
+            uint16_t addr = regs.get(d.rs1) + d.imm;
+            if (m == "SW") {
+                if (addr & 1) {
+                    std::cerr << "Unaligned SW at " << std::hex << addr << "\n";
+                    halted = true;
+                    return;
+                }
+                mem.store16(addr, regs.get(d.rs2));
+            } else if (m == "SB") {
+                if (d.format == FORMAT_S && d.s_op == STOP_SB) {
+                    uint16_t addr = regs.get(d.rs1) + d.imm;
+                    uint8_t value = regs.get(d.rs2) & 0xFF;
+                    std::cout << "[SB] Writing " << std::hex << (int)value << " to 0x" << addr << std::endl;
+                }
+
+                uint8_t val = regs.get(d.rs2) & 0xFF;
+               // std::cout << "[SB] Writing " << +val << " to address " << std::hex << addr << "\n";
+                mem.store8(addr, val);
+            }
+
+            break;
+        }
+
+        case FORMAT_L: {
+            uint16_t addr = regs.get(d.rs2) + d.imm;
+            if (m == "LW") {
+                if (addr & 1) {
+                    std::cerr << "Unaligned LW at " << std::hex << addr << "\n";
+                    halted = true;
+                    return;
+                }
+                regs.set(d.rd, mem.load16(addr));
+            } else if (m == "LB") {
+                regs.set(d.rd, sign_extend(mem.load8(addr), 8));
+            } else if (m == "LBU") {
+                regs.set(d.rd, mem.load8(addr));
+            }
+            break;
+        }
+
+        case FORMAT_B: {
+            bool cond = false;
+            uint16_t rs1_val = regs.get(d.rs1);
+            uint16_t rs2_val = regs.get(d.rs2);
+
+            if (m == "BEQ") cond = rs1_val == rs2_val;
+            else if (m == "BNE") cond = rs1_val != rs2_val;
+            else if (m == "BZ")  cond = rs1_val == 0;  // Only check rs1, ignore rs2
+            else if (m == "BNZ") cond = rs1_val != 0; // Only check rs1, ignore rs2
+            else if (m == "BLT") cond = int16_t(rs1_val) < int16_t(rs2_val);
+            else if (m == "BGE") cond = int16_t(rs1_val) >= int16_t(rs2_val);
+            else if (m == "BLTU") cond = rs1_val < rs2_val;
+            else if (m == "BGEU") cond = rs1_val >= rs2_val;
+
+            if (cond) {
+                // Calculate target from instruction address (PC was already incremented)
+                pc = (pc ) + d.imm;
+                return; // Don't increment PC again
+            }
+            // If condition false, PC increment in main loop handles it
+            break;
+        }
+
+        case FORMAT_J: {
+            if (d.rd != 0) { // JAL
+                regs.set(d.rd, pc); // Save return address (already incremented PC)
+            }
+            // Calculate jump target from instruction address
+            pc = (pc - 2) + d.imm;
+            return; // Don't increment PC again
+        }
+
+        case FORMAT_U: {
+            if (m == "LUI") {
+                regs.set(d.rd, d.imm);
+            } else if (m == "AUIPC") {
+                // Use the PC of the instruction, not the incremented PC
+                uint16_t instruction_pc = pc - 2;  // Subtract 2 to get instruction address
+                regs.set(d.rd, instruction_pc + d.imm);
+            }
+            break;
+        }
+        case FORMAT_SYS: {
+            // ECALL should be handled in main, not here
+            std::cerr << "ECALL should be handled in main, not in ALU" << std::endl;
+            halted = true;
+            break;
+        }
+
+        default:
+            std::cerr << "Unknown format for instruction " << m << std::endl;
+            halted = true;
+            break;
+    }
+}
+
+
+// Instruction encoders (see decoder.cpp for the field layout)
+static uint16_t encodeR(int funct4, int rs2, int rd, int func3) {
+    return (funct4 << 12) | (rs2 << 9) | (rd << 6) | (func3 << 3) | 0x0;
+}
+static uint16_t encodeI(int imm7, int rd, int func3) {
+    return ((imm7 & 0x7F) << 9) | (rd << 6) | (func3 << 3) | 0x1;
+}
+static uint16_t encodeB(int imm4, int rs2, int rs1, int func3) {
+    return ((imm4 & 0xF) << 12) | (rs2 << 9) | (rs1 << 6) | (func3 << 3) | 0x2;
+}
+static uint16_t encodeL(int imm4, int rs2, int rd, int func3) {
+    return ((imm4 & 0xF) << 12) | (rs2 << 9) | (rd << 6) | (func3 << 3) | 0x4;
+}
+static uint16_t encodeU(int flag, int imm9, int rd) {
+    return (flag << 15) | (((imm9 >> 3) & 0x3F) << 9) | (rd << 6) | ((imm9 & 0x7) << 3) | 0x6;
+}
+
+// Mix of ALU, immediate, branch, load and upper-immediate operations.
+// Stores, jumps and ECALL are left out so every pass runs the same stream.
+static std::vector<uint16_t> buildWorkload(size_t count) {
+    static const int rKeys[][2] = {
+        {0x0, 0}, {0x1, 0}, {0x2, 1}, {0x3, 2}, {0x4, 3}, {0x5, 3},
+        {0x6, 3}, {0x7, 4}, {0x8, 5}, {0x9, 6}, {0xA, 7}
+    };
+    std::mt19937 rng(0x2A16);
+    std::vector<uint16_t> words;
+    words.reserve(count);
+
+    while (words.size() < count) {
+        int rd = rng() % 8, rs = rng() % 8;
+        switch (rng() % 5) {
+            case 0: {
+                const int* k = rKeys[rng() % 11];
+                words.push_back(encodeR(k[0], rs, rd, k[1]));
+                break;
+            }
+            case 1:
+                words.push_back(encodeI(rng() % 128, rd, rng() % 8));
+                break;
+            case 2:
+                words.push_back(encodeB(rng() % 16, rs, rd, rng() % 8));
+                break;
+            case 3:
+                // LB / LBU only: LW would stop on odd addresses
+                words.push_back(encodeL(rng() % 16, rs, rd, (rng() & 1) ? 4 : 0));
+                break;
+            default:
+                words.push_back(encodeU(rng() & 1, rng() % 512, rd));
+                break;
+        }
+    }
+    return words;
+}
+
+template <typename Fn>
+static double timeRun(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    int passes = (argc > 1) ? std::atoi(argv[1]) : 50;
+    if (passes <= 0) passes = 50;
+
+    const size_t count = 100000;
+    std::vector<uint16_t> words = buildWorkload(count);
+
+    Decoder decoder;
+    std::vector<DecodedInstruction> decoded;
+    std::vector<PredecodedInstruction> predecoded;
+    decoded.reserve(count);
+    predecoded.reserve(count);
+    for (uint16_t w : words) {
+        decoded.push_back(decoder.decode(w));
+        predecoded.push_back(Decoder::compact(decoded.back()));
+    }
+
+    ALU alu;
+    Memory memLegacy, memTable;
+    Registers regsLegacy, regsTable;
+    bool halted = false;
+
+    double legacySecs = timeRun([&]() {
+        for (int pass = 0; pass < passes; ++pass) {
+            for (size_t i = 0; i < count; ++i) {
+                uint16_t pc = 0x0102;
+                legacyExecute(decoded[i], regsLegacy, memLegacy, pc, halted);
+            }
+        }
+    });
+
+    double tableSecs = timeRun([&]() {
+        for (int pass = 0; pass < passes; ++pass) {
+            for (size_t i = 0; i < count; ++i) {
+                uint16_t pc = 0x0102;
+                alu.execute(predecoded[i], regsTable, memTable, pc, halted);
+            }
+        }
+    });
+
+    // Both paths must end in the same architectural state
+    bool same = true;
+    for (int r = 0; r < 8; ++r) {
+        same = same && (regsLegacy.get(r) == regsTable.get(r));
+    }
+
+    double total = static_cast<double>(count) * passes;
+    double legacyRate = total / legacySecs;
+    double tableRate = total / tableSecs;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "ALU dispatch benchmark: " << count << " instructions x " << passes << " passes" << std::endl;
+    std::cout << "  string compare : " << legacyRate / 1e6 << " M instr/s" << std::endl;
+    std::cout << "  handler table  : " << tableRate / 1e6 << " M instr/s" << std::endl;
+    std::cout << "  speedup        : " << tableRate / legacyRate << "x" << std::endl;
+    std::cout << "  final state    : " << (same ? "match" : "MISMATCH") << std::endl;
+
+    return same ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+// Tile rasterizer benchmark
+// Draws full 320x240 frames from random tile data with the per-nibble
+// reference loop and every rasterTile() path the CPU supports, and checks
+// that all of them produce byte-identical framebuffers.
+//
+// Usage: raster_bench [frames]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+#include "tile_raster.h"
+
+static const int SCREEN_W = 320;
+static const int CELLS_X = 20;
+static const int CELLS = 300;
+
+// Reference: one nibble at a time, palette converted with divisions
+static void referenceFrame(const uint8_t* tiles, const uint8_t* map, const uint8_t* paletteBytes, uint8_t* frame) {
+    for (int cell = 0; cell < CELLS; ++cell) {
+        for (int py = 0; py < 16; ++py) {
+            for (int px = 0; px < 16; ++px) {
+                uint8_t* out = frame + (((cell / CELLS_X) * 16 + py) * SCREEN_W + (cell % CELLS_X) * 16 + px) * 4;
+                if (map[cell] >= 16) {
+                    out[0] = 0; out[1] = 0; out[2] = 0; out[3] = 255;
+                    continue;
+                }
+                int pixelIndex = py * 16 + px;
+                uint8_t packed = tiles[map[cell] * 128 + pixelIndex / 2];
+                uint8_t v = paletteBytes[(pixelIndex % 2 == 0) ? (packed & 0x0F) : (packed >> 4)];
+                out[0] = static_cast<uint8_t>((((v >> 5) & 7) * 255) / 7);
+                out[1] = static_cast<uint8_t>((((v >> 2) & 7) * 255) / 7);
+                out[2] = static_cast<uint8_t>(((v & 3) * 255) / 3);
+                out[3] = 255;
+            }
+        }
+    }
+}
+
+static void lookupFrame(RasterPath path, const TileLookup& lookup, const uint8_t* tiles, const uint8_t* map, uint8_t* frame) {
+    for (int cell = 0; cell < CELLS; ++cell) {
+        uint8_t* dst = frame + ((cell / CELLS_X) * 16 * SCREEN_W + (cell % CELLS_X) * 16) * 4;
+        if (map[cell] < 16) {
+            rasterTile(path, lookup, tiles + map[cell] * 128, dst, SCREEN_W * 4);
+        } else {
+            clearTile(dst, SCREEN_W * 4);
+        }
+    }
+}
+
+template <typename Fn>
+static double timeRun(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    int frames = (argc > 1) ? std::atoi(argv[1]) : 500;
+    if (frames <= 0) frames = 500;
+
+    std::mt19937 rng(0x2A16);
+    std::vector<uint8_t> tiles(16 * 128), map(CELLS), paletteBytes(16);
+    for (uint8_t& b : tiles) b = static_cast<uint8_t>(rng());
+    for (uint8_t& b : map) b = static_cast<uint8_t>(rng() % 18);    // a few blank cells
+    for (uint8_t& b : paletteBytes) b = static_cast<uint8_t>(rng());
+
+    TileLookup lookup;
+    for (int i = 0; i < 16; ++i) setPaletteEntry(lookup, i, paletteBytes[i]);
+    rebuildPairs(lookup);
+
+    const size_t frameBytes = SCREEN_W * 240 * 4;
+    std::vector<uint8_t> expected(frameBytes), actual(frameBytes);
+
+    double refSecs = timeRun([&]() {
+        for (int f = 0; f < frames; ++f) referenceFrame(tiles.data(), map.data(), paletteBytes.data(), expected.data());
+    });
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Tile rasterizer benchmark: " << frames << " frames of 320x240" << std::endl;
+    std::cout << "  reference : " << frames / refSecs << " frames/s" << std::endl;
+
+    bool same = true;
+    RasterPath best = detectRasterPath();
+    for (int p = RASTER_SCALAR; p <= best; ++p) {
+        RasterPath path = static_cast<RasterPath>(p);
+        std::memset(actual.data(), 0xCD, frameBytes);
+        double secs = timeRun([&]() {
+            for (int f = 0; f < frames; ++f) lookupFrame(path, lookup, tiles.data(), map.data(), actual.data());
+        });
+        bool match = std::memcmp(expected.data(), actual.data(), frameBytes) == 0;
+        same = same && match;
+        std::cout << "  " << std::left << std::setw(10) << rasterPathName(path) << std::right << ": "
+                  << frames / secs << " frames/s (" << refSecs / secs << "x) "
+                  << (match ? "match" : "MISMATCH") << std::endl;
+    }
+
+    return same ? 0 : 1;
+}
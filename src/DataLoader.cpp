@@ -49,7 +49,7 @@ bool DataLoader::loadDataSection(const std::string& filename,
 
     // Write data to memory
     for (size_t i = 0; i < dataSection.data.size(); i++) {
-        mem.store8(dataSection.start_address + i, dataSection.data[i]);
+        mem.writeByte(dataSection.start_address + i, dataSection.data[i]);
     }
 
     return true;
@@ -58,10 +58,10 @@ bool DataLoader::loadDataSection(const std::string& filename,
 void DataLoader::addStringToMemory(Memory& mem, uint16_t addr, const std::string& str) {
     try {
         for (size_t i = 0; i < str.length(); i++) {
-            mem.store8(addr + i, static_cast<uint8_t>(str[i]));
+            mem.writeByte(addr + i, static_cast<uint8_t>(str[i]));
         }
         // Add null terminator
-        mem.store8(addr + str.length(), 0);
+        mem.writeByte(addr + str.length(), 0);
         
         std::cout << "Added string \"" << str << "\" at address 0x" 
                   << std::hex << addr << std::endl;
@@ -72,7 +72,7 @@ void DataLoader::addStringToMemory(Memory& mem, uint16_t addr, const std::string
 
 void DataLoader::addIntegerToMemory(Memory& mem, uint16_t addr, int16_t value) {
     try {
-        mem.store16(addr, static_cast<uint16_t>(value));
+        mem.writeHalfWord(addr, static_cast<uint16_t>(value));
         std::cout << "Added integer " << value << " at address 0x" 
                   << std::hex << addr << std::endl;
     } catch (const AddressOutOfBoundsException& e) {
@@ -90,7 +90,7 @@ void DataLoader::printMemoryRegion(const Memory& mem, uint16_t start, uint16_t l
         // Print hex bytes
         for (int j = 0; j < 16 && (i + j) < length; j++) {
             try {
-                uint8_t byte = mem.load8(start + i + j);
+                uint8_t byte = mem.readByte(start + i + j);
                 std::cout << std::hex << std::setw(2) << std::setfill('0') << (int)byte << " ";
             } catch (const AddressOutOfBoundsException&) {
                 std::cout << "?? ";
@@ -101,7 +101,7 @@ void DataLoader::printMemoryRegion(const Memory& mem, uint16_t start, uint16_t l
         std::cout << " |";
         for (int j = 0; j < 16 && (i + j) < length; j++) {
             try {
-                uint8_t byte = mem.load8(start + i + j);
+                uint8_t byte = mem.readByte(start + i + j);
                 char c = (byte >= 32 && byte <= 126) ? byte : '.';
                 std::cout << c;
             } catch (const AddressOutOfBoundsException&) {
@@ -123,7 +123,7 @@ void DataLoader::defineSolidTile(Memory& mem, uint8_t tileIndex, uint8_t color4b
     uint8_t packed = (color4bit & 0x0F) | ((color4bit & 0x0F) << 4);  // two pixels per byte
 
     for (int i = 0; i < 128; ++i) {
-        mem.store8(tileAddr + i, packed);
+        mem.writeByte(tileAddr + i, packed);
     }
 
     std::cout << "Defined tile " << (int)tileIndex << " filled with color " << std::hex << (int)color4bit << std::endl;
@@ -142,9 +142,9 @@ void DataLoader::fillTileMap(Memory& mem, uint8_t tileIndex) {
 
             // Fill only top-left 5×3 area for test
             if (x < 5 && y < 3) {
-                mem.store8(addr, tileIndex);
+                mem.writeByte(addr, tileIndex);
             } else {
-                mem.store8(addr, 0xFF);  // unused tile (transparent / invalid)
+                mem.writeByte(addr, 0xFF);  // unused tile (transparent / invalid)
             }
         }
     }
@@ -6,154 +6,179 @@ static int16_t sign_extend(uint16_t val, int bits) {
     return (val ^ mask) - mask;
 }
 
-void ALU::execute(const DecodedInstruction& d, Registers& regs, Memory& mem, uint16_t& pc, bool& halted, Ecalls& ecalls, Graphics& gfx) {
-    const std::string& m = d.mnemonic;
-
-    switch (d.format) {
-        case FORMAT_R: {
-            uint16_t rs1_val = regs.get(d.rs1);
-            uint16_t rs2_val = regs.get(d.rs2);
-            uint16_t result = 0;
-
-            if (m == "ADD") result = rs1_val + rs2_val;
-            else if (m == "SUB") result = rs1_val - rs2_val;
-            else if (m == "AND") result = rs1_val & rs2_val;
-            else if (m == "OR")  result = rs1_val | rs2_val;
-            else if (m == "XOR") result = rs1_val ^ rs2_val;
-            else if (m == "SLT") result = int16_t(rs1_val) < int16_t(rs2_val) ? 1 : 0;
-            else if (m == "SLTU") result = rs1_val < rs2_val ? 1 : 0;
-            else if (m == "SLL") result = rs1_val << (rs2_val & 0xF);
-            else if (m == "SRL") result = rs1_val >> (rs2_val & 0xF);
-            else if (m == "SRA") result = int16_t(rs1_val) >> (rs2_val & 0xF);
-            else if (m == "MV")  result = rs2_val;
-            else if (m == "JR") {
-                pc = regs.get(d.rd);
-                return;
-            }
-            else if (m == "JALR") {
-                uint16_t ret_addr = pc;
-                pc = regs.get(d.rs2);
-                regs.set(d.rd, ret_addr);
-                return;
-            }
-
-            regs.set(d.rd, result);
-            break;
-        }
-
-        case FORMAT_I: {
-            uint16_t rs1_val = regs.get(d.rs1);
-            int16_t imm = d.imm;
-            uint16_t result = 0;
-
-            if (m == "ADDI") result = rs1_val + imm;
-            else if (m == "LI") result = imm;
-            else if (m == "SLTI") result = int16_t(rs1_val) < imm ? 1 : 0;
-            else if (m == "SLTUI") result = rs1_val < uint16_t(imm) ? 1 : 0;
-            else if (m == "SLLI") result = rs1_val << (imm & 0xF);
-            else if (m == "SRLI") result = rs1_val >> (imm & 0xF);
-            else if (m == "SRAI") result = int16_t(rs1_val) >> (imm & 0xF);
-            else if (m == "ORI") result = rs1_val | imm;
-            else if (m == "ANDI") result = rs1_val & imm;
-            else if (m == "XORI") result = rs1_val ^ imm;
-
-            regs.set(d.rd, result);
-            break;
-        }
-
-        case FORMAT_S: {
-            uint16_t addr = regs.get(d.rs1) + d.imm;
-            if (m == "SW") {
-                if (addr & 1) {
-                    std::cerr << "Unaligned SW at " << std::hex << addr << "\n";
-                    halted = true;
-                    return;
-                }
-                mem.store16(addr, regs.get(d.rs2));
-            } else if (m == "SB") {
-                if (d.format == FORMAT_S && d.s_op == STOP_SB) {
-                    uint16_t addr = regs.get(d.rs1) + d.imm;
-                    uint8_t value = regs.get(d.rs2) & 0xFF;
-                    std::cout << "[SB] Writing " << std::hex << (int)value << " to 0x" << addr << std::endl;
-                }
-
-                uint8_t val = regs.get(d.rs2) & 0xFF;
-               // std::cout << "[SB] Writing " << +val << " to address " << std::hex << addr << "\n";
-                mem.store8(addr, val);
-            }
-
-            break;
-        }
-
-        case FORMAT_L: {
-            uint16_t addr = regs.get(d.rs2) + d.imm;
-            if (m == "LW") {
-                if (addr & 1) {
-                    std::cerr << "Unaligned LW at " << std::hex << addr << "\n";
-                    halted = true;
-                    return;
-                }
-                regs.set(d.rd, mem.load16(addr));
-            } else if (m == "LB") {
-                regs.set(d.rd, sign_extend(mem.load8(addr), 8));
-            } else if (m == "LBU") {
-                regs.set(d.rd, mem.load8(addr));
-            }
-            break;
-        }
-
-        case FORMAT_B: {
-            bool cond = false;
-            uint16_t rs1_val = regs.get(d.rs1);
-            uint16_t rs2_val = regs.get(d.rs2);
-
-            if (m == "BEQ") cond = rs1_val == rs2_val;
-            else if (m == "BNE") cond = rs1_val != rs2_val;
-            else if (m == "BZ")  cond = rs1_val == 0;  // Only check rs1, ignore rs2
-            else if (m == "BNZ") cond = rs1_val != 0; // Only check rs1, ignore rs2
-            else if (m == "BLT") cond = int16_t(rs1_val) < int16_t(rs2_val);
-            else if (m == "BGE") cond = int16_t(rs1_val) >= int16_t(rs2_val);
-            else if (m == "BLTU") cond = rs1_val < rs2_val;
-            else if (m == "BGEU") cond = rs1_val >= rs2_val;
-
-            if (cond) {
-                // Calculate target from instruction address (PC was already incremented)
-                pc = (pc ) + d.imm;
-                return; // Don't increment PC again
-            }
-            // If condition false, PC increment in main loop handles it
-            break;
-        }
-
-        case FORMAT_J: {
-            if (d.rd != 0) { // JAL
-                regs.set(d.rd, pc); // Save return address (already incremented PC)
-            }
-            // Calculate jump target from instruction address
-            pc = (pc - 2) + d.imm;
-            return; // Don't increment PC again
-        }
-
-        case FORMAT_U: {
-            if (m == "LUI") {
-                regs.set(d.rd, d.imm);
-            } else if (m == "AUIPC") {
-                // Use the PC of the instruction, not the incremented PC
-                uint16_t instruction_pc = pc - 2;  // Subtract 2 to get instruction address
-                regs.set(d.rd, instruction_pc + d.imm);
-            }
-            break;
-        }
-        case FORMAT_SYS: {
-            // ECALL should be handled in main, not here
-            std::cerr << "ECALL should be handled in main, not in ALU" << std::endl;
-            halted = true;
-            break;
-        }
-
-        default:
-            std::cerr << "Unknown format for instruction " << m << std::endl;
-            halted = true;
-            break;
+// =============================================================================
+// OPERATION HANDLERS
+// =============================================================================
+
+typedef const PredecodedInstruction& Op;
+
+// R-type: rd doubles as the first source
+static void opAdd(Op p, ExecContext& c)  { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) + c.regs.getFast(p.rs2)); }
+static void opSub(Op p, ExecContext& c)  { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) - c.regs.getFast(p.rs2)); }
+static void opAnd(Op p, ExecContext& c)  { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) & c.regs.getFast(p.rs2)); }
+static void opOr(Op p, ExecContext& c)   { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) | c.regs.getFast(p.rs2)); }
+static void opXor(Op p, ExecContext& c)  { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) ^ c.regs.getFast(p.rs2)); }
+static void opSlt(Op p, ExecContext& c)  { c.regs.setFast(p.rd, int16_t(c.regs.getFast(p.rs1)) < int16_t(c.regs.getFast(p.rs2)) ? 1 : 0); }
+static void opSltu(Op p, ExecContext& c) { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) < c.regs.getFast(p.rs2) ? 1 : 0); }
+static void opSll(Op p, ExecContext& c)  { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) << (c.regs.getFast(p.rs2) & 0xF)); }
+static void opSrl(Op p, ExecContext& c)  { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) >> (c.regs.getFast(p.rs2) & 0xF)); }
+static void opSra(Op p, ExecContext& c)  { c.regs.setFast(p.rd, int16_t(c.regs.getFast(p.rs1)) >> (c.regs.getFast(p.rs2) & 0xF)); }
+static void opMv(Op p, ExecContext& c)   { c.regs.setFast(p.rd, c.regs.getFast(p.rs2)); }
+
+static void opJr(Op p, ExecContext& c) {
+    c.pc = c.regs.getFast(p.rd);
+}
+
+static void opJalr(Op p, ExecContext& c) {
+    uint16_t ret_addr = c.pc;
+    c.pc = c.regs.getFast(p.rs2);
+    c.regs.setFast(p.rd, ret_addr);
+}
+
+static void opUnknownR(Op p, ExecContext& c) {
+    c.regs.setFast(p.rd, 0);
+}
+
+// I-type
+static void opAddi(Op p, ExecContext& c)  { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) + p.imm); }
+static void opLi(Op p, ExecContext& c)    { c.regs.setFast(p.rd, p.imm); }
+static void opSlti(Op p, ExecContext& c)  { c.regs.setFast(p.rd, int16_t(c.regs.getFast(p.rs1)) < p.imm ? 1 : 0); }
+static void opSltui(Op p, ExecContext& c) { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) < uint16_t(p.imm) ? 1 : 0); }
+static void opSlli(Op p, ExecContext& c)  { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) << (p.imm & 0xF)); }
+static void opSrli(Op p, ExecContext& c)  { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) >> (p.imm & 0xF)); }
+static void opSrai(Op p, ExecContext& c)  { c.regs.setFast(p.rd, int16_t(c.regs.getFast(p.rs1)) >> (p.imm & 0xF)); }
+static void opOri(Op p, ExecContext& c)   { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) | p.imm); }
+static void opAndi(Op p, ExecContext& c)  { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) & p.imm); }
+static void opXori(Op p, ExecContext& c)  { c.regs.setFast(p.rd, c.regs.getFast(p.rs1) ^ p.imm); }
+
+// S-type
+static void opSw(Op p, ExecContext& c) {
+    uint16_t addr = c.regs.getFast(p.rs1) + p.imm;
+    if (addr & 1) {
+        std::cerr << "Unaligned SW at " << std::hex << addr << "\n";
+        c.halted = true;
+        return;
+    }
+    c.mem.store16(addr, c.regs.getFast(p.rs2));
+}
+
+static void opSb(Op p, ExecContext& c) {
+    uint16_t addr = c.regs.getFast(p.rs1) + p.imm;
+    uint8_t value = c.regs.getFast(p.rs2) & 0xFF;
+    std::cout << "[SB] Writing " << std::hex << (int)value << " to 0x" << addr << std::endl;
+    c.mem.store8(addr, value);
+}
+
+// L-type: base register is rs2
+static void opLw(Op p, ExecContext& c) {
+    uint16_t addr = c.regs.getFast(p.rs2) + p.imm;
+    if (addr & 1) {
+        std::cerr << "Unaligned LW at " << std::hex << addr << "\n";
+        c.halted = true;
+        return;
+    }
+    c.regs.setFast(p.rd, c.mem.load16(addr));
+}
+
+static void opLb(Op p, ExecContext& c) {
+    uint16_t addr = c.regs.getFast(p.rs2) + p.imm;
+    c.regs.setFast(p.rd, sign_extend(c.mem.load8(addr), 8));
+}
+
+static void opLbu(Op p, ExecContext& c) {
+    uint16_t addr = c.regs.getFast(p.rs2) + p.imm;
+    c.regs.setFast(p.rd, c.mem.load8(addr));
+}
+
+// Unknown S/L encodings are no-ops
+static void opNop(Op, ExecContext&) {}
+
+// B-type: offset is relative to the already incremented PC
+static void opBeq(Op p, ExecContext& c)  { if (c.regs.getFast(p.rs1) == c.regs.getFast(p.rs2)) c.pc += p.imm; }
+static void opBne(Op p, ExecContext& c)  { if (c.regs.getFast(p.rs1) != c.regs.getFast(p.rs2)) c.pc += p.imm; }
+static void opBz(Op p, ExecContext& c)   { if (c.regs.getFast(p.rs1) == 0) c.pc += p.imm; }
+static void opBnz(Op p, ExecContext& c)  { if (c.regs.getFast(p.rs1) != 0) c.pc += p.imm; }
+static void opBlt(Op p, ExecContext& c)  { if (int16_t(c.regs.getFast(p.rs1)) < int16_t(c.regs.getFast(p.rs2))) c.pc += p.imm; }
+static void opBge(Op p, ExecContext& c)  { if (int16_t(c.regs.getFast(p.rs1)) >= int16_t(c.regs.getFast(p.rs2))) c.pc += p.imm; }
+static void opBltu(Op p, ExecContext& c) { if (c.regs.getFast(p.rs1) < c.regs.getFast(p.rs2)) c.pc += p.imm; }
+static void opBgeu(Op p, ExecContext& c) { if (c.regs.getFast(p.rs1) >= c.regs.getFast(p.rs2)) c.pc += p.imm; }
+
+// J-type: links whenever rd != 0, target is relative to the instruction
+static void opJump(Op p, ExecContext& c) {
+    if (p.rd != 0) {
+        c.regs.setFast(p.rd, c.pc);
+    }
+    c.pc = (c.pc - 2) + p.imm;
+}
+
+// U-type
+static void opLui(Op p, ExecContext& c) {
+    c.regs.setFast(p.rd, p.imm);
+}
+
+static void opAuipc(Op p, ExecContext& c) {
+    // Use the PC of the instruction, not the incremented PC
+    c.regs.setFast(p.rd, (c.pc - 2) + p.imm);
+}
+
+static void opSystem(Op, ExecContext& c) {
+    // ECALL should be handled in main, not here
+    std::cerr << "ECALL should be handled in main, not in ALU" << std::endl;
+    c.halted = true;
+}
+
+static void opUndecoded(Op p, ExecContext& c) {
+    std::cerr << "Unknown operation id " << (int)p.op << std::endl;
+    c.halted = true;
+}
+
+namespace {
+struct HandlerTable {
+    OpHandler entries[256];
+
+    HandlerTable() {
+        for (int i = 0; i < 256; ++i) entries[i] = opUndecoded;
+
+        entries[OP_ADD] = opAdd;     entries[OP_SUB] = opSub;
+        entries[OP_SLT] = opSlt;     entries[OP_SLTU] = opSltu;
+        entries[OP_SLL] = opSll;     entries[OP_SRL] = opSrl;
+        entries[OP_SRA] = opSra;     entries[OP_OR] = opOr;
+        entries[OP_AND] = opAnd;     entries[OP_XOR] = opXor;
+        entries[OP_MV] = opMv;       entries[OP_JR] = opJr;
+        entries[OP_JALR] = opJalr;   entries[OP_UNKNOWN_R] = opUnknownR;
+
+        entries[OP_ADDI] = opAddi;   entries[OP_SLTI] = opSlti;
+        entries[OP_SLTUI] = opSltui; entries[OP_SLLI] = opSlli;
+        entries[OP_SRLI] = opSrli;   entries[OP_SRAI] = opSrai;
+        entries[OP_ORI] = opOri;     entries[OP_ANDI] = opAndi;
+        entries[OP_XORI] = opXori;   entries[OP_LI] = opLi;
+
+        entries[OP_BEQ] = opBeq;     entries[OP_BNE] = opBne;
+        entries[OP_BZ] = opBz;       entries[OP_BNZ] = opBnz;
+        entries[OP_BLT] = opBlt;     entries[OP_BGE] = opBge;
+        entries[OP_BLTU] = opBltu;   entries[OP_BGEU] = opBgeu;
+
+        entries[OP_SB] = opSb;       entries[OP_SW] = opSw;
+        entries[OP_UNKNOWN_S] = opNop;
+        entries[OP_LB] = opLb;       entries[OP_LW] = opLw;
+        entries[OP_LBU] = opLbu;     entries[OP_UNKNOWN_L] = opNop;
+
+        entries[OP_J] = opJump;      entries[OP_JAL] = opJump;
+        entries[OP_LUI] = opLui;     entries[OP_AUIPC] = opAuipc;
+
+        entries[OP_ECALL] = opSystem;
+        entries[OP_UNKNOWN_SYS] = opSystem;
     }
+};
+
+// Sized for any uint8_t so OP_UNDECODED (or garbage) can never index out of range
+const HandlerTable handlerTable;
+}
+
+const OpHandler* ALU::handlers() {
+    return handlerTable.entries;
+}
+
+void ALU::execute(const DecodedInstruction& d, Registers& regs, Memory& mem, uint16_t& pc, bool& halted, Ecalls& ecalls, Graphics& gfx) {
+    execute(Decoder::compact(d), regs, mem, pc, halted);
 }
@@ -5,7 +5,27 @@
 #include "ecalls.h"
 #include "graphics.h"
 
+// Machine state an operation handler may touch
+struct ExecContext {
+    Registers& regs;
+    Memory& mem;
+    uint16_t& pc;      // already points at the next instruction
+    bool& halted;
+};
+
+// One handler per OpId
+typedef void (*OpHandler)(const PredecodedInstruction& instr, ExecContext& ctx);
+
 class ALU {
 public:
     void execute(const DecodedInstruction& instr, Registers& regs, Memory& mem, uint16_t& pc, bool& halted, Ecalls& ecalls, Graphics& gfx);
+
+    // Same semantics, dispatched through the handler table on the flat OpId
+    void execute(const PredecodedInstruction& instr, Registers& regs, Memory& mem, uint16_t& pc, bool& halted) {
+        ExecContext ctx = { regs, mem, pc, halted };
+        handlers()[instr.op](instr, ctx);
+    }
+
+    // Jump table indexed by OpId (OP_COUNT entries)
+    static const OpHandler* handlers();
 };
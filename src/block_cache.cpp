@@ -0,0 +1,272 @@
+#include "block_cache.h"
+#include "jit_x64.h"
+#include <algorithm>
+
+static bool endsBlock(uint8_t op) {
+    switch (op) {
+        case OP_JR: case OP_JALR:
+        case OP_BEQ: case OP_BNE: case OP_BZ: case OP_BNZ:
+        case OP_BLT: case OP_BGE: case OP_BLTU: case OP_BGEU:
+        case OP_J: case OP_JAL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// ECALL and unknown SYS encodings always go through Simulator::step()
+static bool needsSimulator(uint8_t op) {
+    return op == OP_ECALL || op == OP_UNKNOWN_SYS;
+}
+
+BlockCache::BlockCache(Memory& mem, PredecodeCache& predecode)
+    : memory(mem), predecode(predecode), jit(nullptr),
+      blockAt(MEMORY_SIZE / 2, nullptr),
+      pageBlocks(MEMORY_PAGE_COUNT),
+      running(false), selfLoops(0), lastExitPc(0),
+      translations(0), chainedTransfers(0), invalidations(0) {
+    memory.addCodeWriteListener(this);
+}
+
+BlockCache::~BlockCache() {
+    memory.removeCodeWriteListener(this);
+    invalidateAll();
+    releaseRetired();
+}
+
+TranslatedBlock* BlockCache::lookup(uint16_t pc) {
+    TranslatedBlock* block = blockAt[pc >> 1];
+    if (block && block->startPc == pc) {
+        return block;
+    }
+    return translate(pc);
+}
+
+TranslatedBlock* BlockCache::translate(uint16_t pc) {
+    // Odd PCs fault in predecode.fetch(), exactly like the single-step path
+    if (needsSimulator(predecode.fetch(pc).op)) {
+        return nullptr;
+    }
+
+    TranslatedBlock* block = new TranslatedBlock();
+    block->startPc = pc;
+    block->valid = true;
+    block->successorPc[0] = block->successorPc[1] = 0;
+    block->successor[0] = block->successor[1] = nullptr;
+    block->execCount = 0;
+    block->native = nullptr;
+    block->nativeGeneration = 0;
+
+    uint32_t cur = pc;
+    while (block->ops.size() < MAX_BLOCK_LENGTH) {
+        const PredecodedInstruction& p = predecode.fetch(static_cast<uint16_t>(cur));
+        if (needsSimulator(p.op)) {
+            break;
+        }
+        block->ops.push_back(p);
+        cur += 2;
+        if (endsBlock(p.op) || cur >= MEMORY_SIZE) {
+            break;
+        }
+    }
+    block->endPc = cur;
+
+    // Register with every page the block covers so stores can find it
+    uint32_t lastByte = static_cast<uint32_t>(pc) + block->ops.size() * 2 - 1;
+    for (uint32_t page = pc >> MEMORY_PAGE_SHIFT; page <= (lastByte >> MEMORY_PAGE_SHIFT); ++page) {
+        pageBlocks[page].push_back(block);
+    }
+
+    blockAt[pc >> 1] = block;
+    translations++;
+    return block;
+}
+
+uint32_t BlockCache::execute(TranslatedBlock& block, ExecContext& ctx, uint64_t budget, uint64_t& executed) {
+    const OpHandler* handlers = ALU::handlers();
+    uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(block.ops.size(), budget));
+    uint16_t pc = block.startPc;
+    uint32_t i = 0;
+
+    block.execCount++;
+    if (jit && count == block.ops.size()) {
+        if (!jit->hasNative(block) && block.execCount >= JitCompiler::HOT_THRESHOLD) {
+            jit->compile(block);
+        }
+        if (jit->hasNative(block)) {
+            // Faults come back as exceptions with ctx.pc already at the faulting instruction
+            uint32_t retired = 0;
+            try {
+                retired = jit->execute(block, ctx);
+            } catch (...) {
+                executed += static_cast<uint32_t>((ctx.pc - block.startPc) & 0xFFFF) / 2;
+                throw;
+            }
+            executed += retired;
+            return retired;
+        }
+    }
+
+    try {
+        for (; i < count; ++i) {
+            const PredecodedInstruction& op = block.ops[i];
+            ctx.pc = pc + 2;
+            handlers[op.op](op, ctx);
+
+            // Stop on halt, or right after a store that rewrote this block
+            if (ctx.halted || !block.valid) {
+                executed += i + 1;
+                return i + 1;
+            }
+            pc += 2;
+        }
+    } catch (...) {
+        // Report the fault where the single-step loop would
+        ctx.pc = pc;
+        executed += i;
+        throw;
+    }
+    executed += count;
+    return count;
+}
+
+TranslatedBlock* BlockCache::next(TranslatedBlock& from, uint16_t pc) {
+    for (int i = 0; i < 2; ++i) {
+        if (from.successor[i] && from.successorPc[i] == pc) {
+            chainedTransfers++;
+            return from.successor[i];
+        }
+    }
+
+    TranslatedBlock* to = lookup(pc);
+    if (!to) {
+        return nullptr;
+    }
+
+    // Chain into a free exit, otherwise evict the second one
+    int slot = from.successor[0] ? 1 : 0;
+    if (from.successor[slot]) {
+        std::vector<TranslatedBlock*>& preds = from.successor[slot]->predecessors;
+        preds.erase(std::remove(preds.begin(), preds.end(), &from), preds.end());
+    }
+    from.successor[slot] = to;
+    from.successorPc[slot] = pc;
+    to->predecessors.push_back(&from);
+    return to;
+}
+
+void BlockCache::run(ExecContext& ctx, uint64_t budget, uint32_t loopLimit, BlockRunResult& result) {
+    result.executed = 0;
+    result.infiniteLoop = false;
+    if (ctx.pc != lastExitPc) {
+        selfLoops = 0;    // something else (an ECALL step) ran in between
+    }
+
+    releaseRetired();
+    running = true;
+
+    try {
+        TranslatedBlock* block = lookup(ctx.pc);
+        while (block && result.executed < budget) {
+            uint32_t n = execute(*block, ctx, budget - result.executed, result.executed);
+
+            if (ctx.halted || !block->valid || n < block->ops.size()) {
+                break;
+            }
+
+            // Same check as the single-step loop detector: the last instruction
+            // jumped to itself more than loopLimit times in a row
+            if (loopLimit != 0) {
+                if (ctx.pc == static_cast<uint16_t>(block->startPc + (n - 1) * 2)) {
+                    if (++selfLoops > loopLimit) {
+                        result.infiniteLoop = true;
+                        break;
+                    }
+                } else {
+                    selfLoops = 0;
+                }
+            }
+
+            block = next(*block, ctx.pc);
+        }
+    } catch (...) {
+        running = false;
+        throw;
+    }
+
+    running = false;
+    lastExitPc = ctx.pc;
+    releaseRetired();
+}
+
+void BlockCache::invalidate(TranslatedBlock* block) {
+    if (!block->valid) {
+        return;
+    }
+    block->valid = false;
+    invalidations++;
+
+    // Unlink in both directions so no chain can reach it again
+    for (TranslatedBlock* pred : block->predecessors) {
+        for (int i = 0; i < 2; ++i) {
+            if (pred->successor[i] == block) {
+                pred->successor[i] = nullptr;
+            }
+        }
+    }
+    block->predecessors.clear();
+    for (int i = 0; i < 2; ++i) {
+        TranslatedBlock* succ = block->successor[i];
+        if (succ) {
+            std::vector<TranslatedBlock*>& preds = succ->predecessors;
+            preds.erase(std::remove(preds.begin(), preds.end(), block), preds.end());
+            block->successor[i] = nullptr;
+        }
+    }
+
+    if (blockAt[block->startPc >> 1] == block) {
+        blockAt[block->startPc >> 1] = nullptr;
+    }
+
+    uint32_t lastByte = static_cast<uint32_t>(block->startPc) + block->ops.size() * 2 - 1;
+    for (uint32_t page = block->startPc >> MEMORY_PAGE_SHIFT; page <= (lastByte >> MEMORY_PAGE_SHIFT); ++page) {
+        std::vector<TranslatedBlock*>& list = pageBlocks[page];
+        list.erase(std::remove(list.begin(), list.end(), block), list.end());
+    }
+
+    // The block may be executing right now; free it once run() is done
+    retired.push_back(block);
+}
+
+void BlockCache::invalidateAll() {
+    for (uint32_t page = 0; page < MEMORY_PAGE_COUNT; ++page) {
+        std::vector<TranslatedBlock*> list = pageBlocks[page];
+        for (TranslatedBlock* block : list) {
+            invalidate(block);
+        }
+    }
+}
+
+void BlockCache::onCodeWrite(uint32_t addr, uint32_t size) {
+    uint32_t end = addr + size;
+    for (uint32_t page = addr >> MEMORY_PAGE_SHIFT;
+         page <= ((end - 1) >> MEMORY_PAGE_SHIFT) && page < MEMORY_PAGE_COUNT; ++page) {
+        // Copy: invalidate() edits the page list
+        std::vector<TranslatedBlock*> list = pageBlocks[page];
+        for (TranslatedBlock* block : list) {
+            if (addr < block->endPc && end > block->startPc) {
+                invalidate(block);
+            }
+        }
+    }
+}
+
+void BlockCache::releaseRetired() {
+    if (running) {
+        return;
+    }
+    for (TranslatedBlock* block : retired) {
+        delete block;
+    }
+    retired.clear();
+}
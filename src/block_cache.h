@@ -0,0 +1,87 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include <cstdint>
+#include <vector>
+#include "alu.h"
+#include "predecode.h"
+
+class JitCompiler;
+
+// A straight-line run of predecoded instructions. Translation stops after the
+// first B/J/JR/JALR, before an ECALL (the simulator handles those itself), or
+// at MAX_BLOCK_LENGTH instructions.
+struct TranslatedBlock {
+    uint16_t startPc;
+    uint32_t endPc;                          // address just past the last instruction
+    std::vector<PredecodedInstruction> ops;
+    bool valid;
+
+    // Chaining: the last two distinct exits and the blocks they lead to
+    uint16_t successorPc[2];
+    TranslatedBlock* successor[2];
+    std::vector<TranslatedBlock*> predecessors;
+
+    uint64_t execCount;
+
+    // Native code from JitCompiler, valid while nativeGeneration matches
+    void* native;
+    uint32_t nativeGeneration;
+};
+
+struct BlockRunResult {
+    uint64_t executed;     // instructions retired
+    bool infiniteLoop;     // an instruction kept jumping to itself
+};
+
+class BlockCache : public CodeWriteListener {
+public:
+    static const uint32_t MAX_BLOCK_LENGTH = 64;
+
+    BlockCache(Memory& mem, PredecodeCache& predecode);
+    ~BlockCache();
+
+    // Run chained blocks from ctx.pc until the budget is used up, the program
+    // halts, or the next instruction cannot start a block (ECALL). loopLimit
+    // of 0 disables self-loop detection. result stays accurate if a memory
+    // exception escapes, with ctx.pc left at the faulting instruction.
+    void run(ExecContext& ctx, uint64_t budget, uint32_t loopLimit, BlockRunResult& result);
+
+    // Block starting at pc, translating it on first use; nullptr if pc holds an ECALL
+    TranslatedBlock* lookup(uint16_t pc);
+
+    // Compile blocks that run JitCompiler::HOT_THRESHOLD times (nullptr = interpret only)
+    void setJit(JitCompiler* compiler) { jit = compiler; }
+
+    void invalidateAll();
+    void onCodeWrite(uint32_t addr, uint32_t size) override;
+
+    // Statistics
+    uint64_t getTranslationCount() const { return translations; }
+    uint64_t getChainCount() const { return chainedTransfers; }
+    uint64_t getInvalidationCount() const { return invalidations; }
+
+private:
+    TranslatedBlock* translate(uint16_t pc);
+    uint32_t execute(TranslatedBlock& block, ExecContext& ctx, uint64_t budget, uint64_t& executed);
+    TranslatedBlock* next(TranslatedBlock& from, uint16_t pc);
+    void invalidate(TranslatedBlock* block);
+    void releaseRetired();
+
+    Memory& memory;
+    PredecodeCache& predecode;
+    JitCompiler* jit;
+
+    std::vector<TranslatedBlock*> blockAt;                    // indexed by PC / 2
+    std::vector<std::vector<TranslatedBlock*> > pageBlocks;   // blocks touching each memory page
+    std::vector<TranslatedBlock*> retired;                    // invalidated, freed outside run()
+    bool running;
+    uint32_t selfLoops;    // consecutive self-jumps, kept across run() calls
+    uint16_t lastExitPc;
+
+    uint64_t translations;
+    uint64_t chainedTransfers;
+    uint64_t invalidations;
+};
+
+#endif // BLOCK_CACHE_H
@@ -0,0 +1,38 @@
+#include "decode_table.h"
+#include <iomanip>
+
+const PredecodedInstruction DECODE_TABLE[DECODE_TABLE_SIZE] = {
+#include "decode_table.inc"
+};
+
+static bool sameRecord(const PredecodedInstruction& a, const PredecodedInstruction& b) {
+    return a.raw == b.raw && a.imm == b.imm && a.op == b.op &&
+           a.rd == b.rd && a.rs1 == b.rs1 && a.rs2 == b.rs2;
+}
+
+uint32_t verifyDecodeTable(std::ostream& out) {
+    Decoder decoder;
+    uint32_t mismatches = 0;
+
+    for (uint32_t word = 0; word < DECODE_TABLE_SIZE; ++word) {
+        DecodedInstruction d = decoder.decode(static_cast<uint16_t>(word));
+        PredecodedInstruction expected = Decoder::compact(d);
+        const PredecodedInstruction& actual = DECODE_TABLE[word];
+
+        if (actual.raw == word && sameRecord(actual, expected)) {
+            continue;
+        }
+
+        if (mismatches < 8) {
+            out << "Decode table mismatch for 0x" << std::hex << std::setw(4) << std::setfill('0') << word
+                << std::dec << " (" << formatInstruction(d) << "): table op=" << (int)actual.op
+                << " imm=" << actual.imm << ", decoder op=" << (int)expected.op
+                << " imm=" << expected.imm << std::endl;
+        }
+        mismatches++;
+    }
+
+    out << "Decode table check: " << (DECODE_TABLE_SIZE - mismatches) << "/" << DECODE_TABLE_SIZE
+        << " words match Decoder::decode" << std::endl;
+    return mismatches;
+}
@@ -0,0 +1,21 @@
+#ifndef DECODE_TABLE_H
+#define DECODE_TABLE_H
+
+#include <cstdint>
+#include <ostream>
+#include "decoder.h"
+
+// Every possible ZX16 instruction word, predecoded at build time
+// (tools/gen_decode_table.cpp). Decoding is a single indexed load.
+const uint32_t DECODE_TABLE_SIZE = 0x10000;
+extern const PredecodedInstruction DECODE_TABLE[DECODE_TABLE_SIZE];
+
+inline const PredecodedInstruction& lookupDecoded(uint16_t word) {
+    return DECODE_TABLE[word];
+}
+
+// Exhaustive equivalence check of the table against Decoder::decode.
+// Prints up to a handful of mismatches and returns how many words differ.
+uint32_t verifyDecodeTable(std::ostream& out);
+
+#endif // DECODE_TABLE_H
@@ -1,4 +1,4 @@
-#include "Decoder.h"
+#include "decoder.h"
 #include "utils.h"
 #include <iostream>
 #include <iomanip>
@@ -389,4 +389,122 @@ DecodedInstruction Decoder::decode(uint16_t inst) {
     }
 
     return d;
-}
\ No newline at end of file
+}
+// Compact (string-free) form used by the predecode cache
+PredecodedInstruction Decoder::compact(const DecodedInstruction& d) {
+    PredecodedInstruction p;
+    p.raw = d.raw;
+    p.imm = d.imm;
+    p.rd  = d.rd;
+    p.rs1 = d.rs1;
+    p.rs2 = d.rs2;
+
+    switch (d.format) {
+        case FORMAT_R:
+            p.op = (d.r_op == RTOP_UNKNOWN) ? OP_UNKNOWN_R
+                                            : static_cast<uint8_t>(OP_ADD + (d.r_op - RTOP_ADD));
+            break;
+        case FORMAT_I:
+            p.op = static_cast<uint8_t>(OP_ADDI + (d.i_op - ITOP_ADDI));
+            break;
+        case FORMAT_B:
+            p.op = static_cast<uint8_t>(OP_BEQ + (d.b_op - BTOP_BEQ));
+            break;
+        case FORMAT_S:
+            p.op = (d.s_op == STOP_UNKNOWN) ? OP_UNKNOWN_S
+                                            : static_cast<uint8_t>(OP_SB + (d.s_op - STOP_SB));
+            break;
+        case FORMAT_L:
+            p.op = (d.l_op == LTOP_UNKNOWN) ? OP_UNKNOWN_L
+                                            : static_cast<uint8_t>(OP_LB + (d.l_op - LTOP_LB));
+            break;
+        case FORMAT_J:
+            p.op = (d.j_op == JTOP_JAL) ? OP_JAL : OP_J;
+            break;
+        case FORMAT_U:
+            p.op = (d.u_op == UTOP_AUIPC) ? OP_AUIPC : OP_LUI;
+            break;
+        case FORMAT_SYS:
+            p.op = (d.sys_op == SYSOP_ECALL) ? OP_ECALL : OP_UNKNOWN_SYS;
+            p.imm = static_cast<int16_t>(d.syscall_num);
+            break;
+        default:
+            p.op = OP_UNKNOWN_SYS;
+            break;
+    }
+    return p;
+}
+
+PredecodedInstruction Decoder::predecode(uint16_t inst) {
+    return compact(decode(inst));
+}
+
+// Human-readable form of a decoded instruction (used for tracing/debug output)
+std::string formatInstruction(const DecodedInstruction& d) {
+    std::string result = d.mnemonic;
+
+    // Check for NOP (ADD x0, x0, x0)
+    if (d.format == FORMAT_R && d.mnemonic == "ADD" && d.rd == 0 && d.rs1 == 0 && d.rs2 == 0) {
+        return "NOP";
+    }
+
+    switch (d.format) {
+        case FORMAT_R:
+            if (d.mnemonic == "MV") {
+                result += " x" + std::to_string(d.rd) + ", x" + std::to_string(d.rs2);
+            }
+            else if (d.mnemonic == "JR") {
+                result += " x" + std::to_string(d.rd);
+            }
+            else if (d.mnemonic == "JALR") {
+                result += " x" + std::to_string(d.rd) + ", x" + std::to_string(d.rs2);
+            }
+            else {
+                result += " x" + std::to_string(d.rd) + ", x" + std::to_string(d.rs2);
+            }
+            break;
+
+        case FORMAT_I:
+            result += " x" + std::to_string(d.rd) + ", " + std::to_string(d.imm);
+            break;
+
+        case FORMAT_S:
+            result += " x" + std::to_string(d.rs2) + ", " + std::to_string(d.imm) + "(x" + std::to_string(d.rs1) + ")";
+            break;
+
+        case FORMAT_L:
+            result += " x" + std::to_string(d.rd) + ", " + std::to_string(d.imm) + "(x" + std::to_string(d.rs2) + ")";
+            break;
+
+        case FORMAT_B:
+            if (d.mnemonic == "BZ" || d.mnemonic == "BNZ") {
+                result += " x" + std::to_string(d.rs1) + ", " + std::to_string(d.imm);
+            } else {
+                result += " x" + std::to_string(d.rs1) + ", x" + std::to_string(d.rs2) + ", " + std::to_string(d.imm);
+            }
+            break;
+
+        case FORMAT_J:
+            if (d.rd != 0) {
+                result += " x" + std::to_string(d.rd) + ", " + std::to_string(d.imm);
+            } else {
+                result += " " + std::to_string(d.imm);
+            }
+            break;
+
+        case FORMAT_U:
+            result += " x" + std::to_string(d.rd) + ", " + std::to_string(d.imm);
+            break;
+
+        case FORMAT_SYS:
+            if (d.sys_op == SYSOP_ECALL) {
+                result += " " + std::to_string(d.imm);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return result;
+}
@@ -81,10 +81,40 @@ struct DecodedInstruction {
     SysTypeOp sys_op = SYSOP_UNKNOWN;
 };
 
+// Flat operation IDs - one per executable operation, independent of format.
+// The UNKNOWN_* entries keep the per-format fallback behaviour of ALU::execute.
+enum OpId : uint8_t {
+    OP_ADD = 0, OP_SUB, OP_SLT, OP_SLTU, OP_SLL, OP_SRL, OP_SRA,
+    OP_OR, OP_AND, OP_XOR, OP_MV, OP_JR, OP_JALR, OP_UNKNOWN_R,
+    OP_ADDI, OP_SLTI, OP_SLTUI, OP_SLLI, OP_SRLI, OP_SRAI,
+    OP_ORI, OP_ANDI, OP_XORI, OP_LI,
+    OP_BEQ, OP_BNE, OP_BZ, OP_BNZ, OP_BLT, OP_BGE, OP_BLTU, OP_BGEU,
+    OP_SB, OP_SW, OP_UNKNOWN_S,
+    OP_LB, OP_LW, OP_LBU, OP_UNKNOWN_L,
+    OP_J, OP_JAL,
+    OP_LUI, OP_AUIPC,
+    OP_ECALL, OP_UNKNOWN_SYS,
+    OP_COUNT,
+    OP_UNDECODED = 0xFF   // empty predecode cache slot
+};
+
+// Compact, string-free form of DecodedInstruction (8 bytes).
+// For ECALL, imm holds the service number.
+struct PredecodedInstruction {
+    uint16_t raw;
+    int16_t imm;
+    uint8_t op;
+    uint8_t rd, rs1, rs2;
+};
+
 class Decoder {
 public:
     DecodedInstruction decode(uint16_t instruction);
 
+    // Decode straight into the compact execution record
+    PredecodedInstruction predecode(uint16_t instruction);
+    static PredecodedInstruction compact(const DecodedInstruction& d);
+
 private:
     InstructionFormat getInstructionFormat(uint16_t inst);
     RTypeOp decodeRTypeOperation(uint16_t inst);
@@ -119,4 +149,7 @@ private:
     int16_t signExtend4(uint8_t imm4);
     int16_t signExtend7(uint8_t imm7);
     int16_t signExtend10(uint16_t imm10);
-};
\ No newline at end of file
+};
+
+// Disassemble one decoded instruction, e.g. "ADDI x3, 8"
+std::string formatInstruction(const DecodedInstruction& d);
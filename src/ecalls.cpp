@@ -1,5 +1,5 @@
 #include "ecalls.h"
-#include "Decoder.h"
+#include "decoder.h"
 #include "memory.h"
 #include "registers.h"
 #include <iostream>
@@ -7,8 +7,12 @@
 #include <sstream>
 #include <limits>
 #include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#ifdef _WIN32
 #include <windows.h>
-#include<atomic>
+#endif
 Ecalls::~Ecalls() {
     // Clean up any remaining audio thread
     static std::unique_ptr<std::thread> sound_thread = nullptr;
@@ -5,7 +5,7 @@
 #include <string>
 #include <vector>
 #include <map>
-#include"Graphics.h"
+#include "graphics.h"
 // Forward declarations
 struct DecodedInstruction;
 class Registers;
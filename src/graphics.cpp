@@ -1,7 +1,8 @@
-#include "Graphics.h"
-#include "Memory.h"
+#include "graphics.h"
+#include "memory.h"
 #include <iostream>
 #include <cstring>
+#include <algorithm>
 
 // Add these implementations to your Graphics.cpp file
 
@@ -20,13 +21,35 @@ Graphics::Graphics(Memory* mem)
       screenSprite(),
       window(),
       lastKeyPressed(0),        // ADD THIS LINE
-      hasNewKeyPress(false) {   // ADD THIS LINE
+      hasNewKeyPress(false),    // ADD THIS LINE
+      threaded(false),
+      vramWritten(true),
+      stopRendering(false),
+      windowOpen(false),
+      fullRedraw(true),
+      framePixels(SCREEN_WIDTH * SCREEN_HEIGHT * 4, 0),
+      cellPixels(TILE_SIZE * TILE_SIZE * 4, 0),
+      rasterPath(detectRasterPath()) {
+    std::fill(cellDirty, cellDirty + TOTAL_TILES, false);
+    std::memset(&shownVram, 0, sizeof(shownVram));
+    std::fill(tileColorUsage, tileColorUsage + 16, 0);
+    std::memset(&tileLookup, 0, sizeof(tileLookup));
+    if (memory) {
+        memory->mapDevice(TILE_MAP_START, TILE_MAP_END, this);
+        memory->mapDevice(TILE_DATA_START, TILE_DATA_END, this);
+        memory->mapDevice(PALETTE_START, PALETTE_END, this);
+    }
     std::cout << "Graphics system created, waiting for initialization..." << std::endl;
 }
 
 // 2. ADD THESE NEW METHODS at the end of your graphics.cpp file:
 
-uint16_t Graphics::getLastKeyPressed() const {
+uint16_t Graphics::getLastKeyPressed() {
+    uint16_t keyCode;
+    while (keyEvents.pop(keyCode)) {
+        lastKeyPressed = keyCode;
+        hasNewKeyPress = true;
+    }
     if (hasNewKeyPress) {
         return lastKeyPressed;
     }
@@ -116,8 +139,7 @@ void Graphics::handleEvents() {
         if (event.type == sf::Event::KeyPressed) {
             uint16_t keyCode = convertSFMLKeyToCode(event.key.code);
             if (keyCode != 0) {
-                lastKeyPressed = keyCode;
-                hasNewKeyPress = true;
+                keyEvents.push(keyCode);
                 std::cout << "SFML Key pressed: " << (char)keyCode << " (code: " << keyCode << ")" << std::endl;
             }
         }
@@ -132,13 +154,68 @@ void Graphics::handleEvents() {
 
 
 Graphics::~Graphics() {
+    shutdown();
+    if (memory) {
+        memory->unmapDevice(this);
+    }
     if (window.isOpen()) {
         window.close();
     }
     std::cout << "Graphics system destroyed." << std::endl;
 }
 
-bool Graphics::initialize() {
+bool Graphics::initialize(bool useRenderThread) {
+    if (!useRenderThread) {
+        isInitialized = createWindow();
+        windowOpen = isInitialized;
+        return isInitialized;
+    }
+
+    // The window is created on the render thread so that it also owns the
+    // GL context and the event queue
+    std::promise<bool> ready;
+    std::future<bool> created = ready.get_future();
+    stopRendering = false;
+    renderThread = std::thread(&Graphics::renderLoop, this, &ready);
+    if (!created.get()) {
+        renderThread.join();
+        return false;
+    }
+    threaded = true;
+    isInitialized = true;
+    return true;
+}
+
+void Graphics::shutdown() {
+    if (renderThread.joinable()) {
+        stopRendering = true;
+        renderThread.join();
+    }
+    threaded = false;
+}
+
+void Graphics::renderLoop(std::promise<bool>* ready) {
+    bool created = createWindow();
+    windowOpen = created;
+    ready->set_value(created);
+    if (!created) {
+        return;
+    }
+
+    while (!stopRendering && window.isOpen()) {
+        handleEvents();
+        if (snapshots.acquire()) {
+            renderSnapshot(snapshots.readBuffer().bytes);
+        }
+        presentFrame();    // paced to 60 FPS by the window
+    }
+    windowOpen = false;
+    if (window.isOpen()) {
+        window.close();
+    }
+}
+
+bool Graphics::createWindow() {
     try {
         const int scaleFactor = 3;
         // Create SFML window with correct ZX16 resolution
@@ -159,8 +236,8 @@ window.hasFocus();
 
         // Create sprite from texture
         screenSprite.setTexture(screenTexture);
+        fullRedraw = true;
 
-        isInitialized = true;
         std::cout << "Graphics system initialized successfully!" << std::endl;
         std::cout << "Screen: " << SCREEN_WIDTH << "x" << SCREEN_HEIGHT << std::endl;
         std::cout << "Tiles: " << TILES_HORIZONTAL << "x" << TILES_VERTICAL
@@ -180,7 +257,10 @@ window.hasFocus();
 }
 
 bool Graphics::isWindowOpen() {
-    return window.isOpen();
+    if (!threaded) {
+        windowOpen = window.isOpen();
+    }
+    return windowOpen;
 }
 
 
@@ -188,11 +268,28 @@ void Graphics::markDirty() {
     needsUpdate = true;
 }
 
+void Graphics::onMmioWrite(uint16_t, uint16_t, uint32_t) {
+    vramWritten = true;
+    needsUpdate = true;
+}
+
 void Graphics::update() {
     if (!isInitialized) {
         return;
     }
 
+    if (threaded) {
+        // Hand the render thread a fresh copy; it never reads live memory
+        if (vramWritten && memory) {
+            std::memcpy(snapshots.writeBuffer().bytes, memory->hostData() + GRAPHICS_MEMORY_START,
+                        VRAM_SNAPSHOT_SIZE);
+            snapshots.publish();
+            vramWritten = false;
+        }
+        needsUpdate = false;
+        return;
+    }
+
     // Handle window events first
     handleEvents();
 
@@ -204,169 +301,162 @@ void Graphics::update() {
 }
 
 // Convert 3-3-2 RGB palette byte to SFML Color
+// Bits 7-5: Red (3 bits), Bits 4-2: Green (3 bits), Bits 1-0: Blue (2 bits)
 sf::Color Graphics::convertPaletteColor(uint8_t paletteValue) {
-    // Extract RGB components using ZX16 3-3-2 format
-    // Bits 7-5: Red (3 bits)
-    // Bits 4-2: Green (3 bits)
-    // Bits 1-0: Blue (2 bits)
-
-    uint8_t red3   = (paletteValue >> 5) & 0x07;  // Extract bits 7-5
-    uint8_t green3 = (paletteValue >> 2) & 0x07;  // Extract bits 4-2
-    uint8_t blue2  = (paletteValue >> 0) & 0x03;  // Extract bits 1-0
-
-    // Convert to 8-bit values (scale up)
-    uint8_t red8   = (red3   * 255) / 7;  // Scale 3-bit to 8-bit
-    uint8_t green8 = (green3 * 255) / 7;  // Scale 3-bit to 8-bit
-    uint8_t blue8  = (blue2  * 255) / 3;  // Scale 2-bit to 8-bit
+    uint32_t pixel = rgb332ToPixel(paletteValue);
+    uint8_t rgba[4];
+    std::memcpy(rgba, &pixel, 4);
+    return sf::Color(rgba[0], rgba[1], rgba[2]);
+}
 
-    return sf::Color(red8, green8, blue8);
+void Graphics::setRasterPath(RasterPath path) {
+    // Never pick an instruction set the CPU lacks
+    RasterPath best = detectRasterPath();
+    rasterPath = (path <= best) ? path : best;
 }
+
 void Graphics::renderFrame() {
     if (!memory) {
         std::cerr << "Error: Memory not available for graphics rendering!" << std::endl;
         return;
     }
 
-    // Clear screen to black
-    screenImage.create(SCREEN_WIDTH, SCREEN_HEIGHT, sf::Color::Black);
+    renderSnapshot(memory->hostData() + GRAPHICS_MEMORY_START);
+    presentFrame();
+}
 
-    static bool first_render = true;
-    if (first_render) {
-        std::cout << "=== FIRST RENDER DEBUG ===" << std::endl;
-        first_render = false;
-    }
+void Graphics::presentFrame() {
+    window.clear();
+    window.draw(screenSprite);
+    window.display();
+}
+
+// vram points at a copy of 0xF000 - 0xFA0F
+void Graphics::renderSnapshot(const uint8_t* vram) {
+    const uint8_t* tileMap = vram + (TILE_MAP_START - GRAPHICS_MEMORY_START);
+    const uint8_t* tileData = vram + (TILE_DATA_START - GRAPHICS_MEMORY_START);
+    const uint8_t* palette = vram + (PALETTE_START - GRAPHICS_MEMORY_START);
+    const uint8_t* shown = shownVram.bytes;
 
     static int frame_count = 0;
     bool show_debug = (frame_count < 1); // Only show debug for first frame
     frame_count++;
 
-    // Load color palette from memory (0xFA00 - 0xFA0F)
-    sf::Color palette[16];
+    // What changed since the frame on screen
+    uint16_t paletteDirty = 0;
+    uint16_t tileDataDirty = 0;
     for (int i = 0; i < 16; ++i) {
-        try {
-            uint8_t paletteValue = memory->load8(0xFA00 + i);
-            palette[i] = convertPaletteColor(paletteValue);
-
-            if (i < 5 && show_debug) {  // Debug first 5 palette entries only on first frame
-                std::cout << "Palette[" << i << "] = 0x" << std::hex << (int)paletteValue
-                          << " -> RGB(" << (int)palette[i].r << "," << (int)palette[i].g
-                          << "," << (int)palette[i].b << ")" << std::endl;
-            }
-        } catch (const AddressOutOfBoundsException& e) {
-            // Use bright default colors for testing
-            switch(i) {
-                case 0: palette[i] = sf::Color::Red; break;
-                case 1: palette[i] = sf::Color::Blue; break;
-                case 2: palette[i] = sf::Color::Green; break;
-                case 3: palette[i] = sf::Color::Yellow; break;
-                case 4: palette[i] = sf::Color::White; break;
-                default: palette[i] = sf::Color::Black; break;
-            }
-            std::cout << "Palette[" << i << "] = DEFAULT RGB(" << (int)palette[i].r
-                      << "," << (int)palette[i].g << "," << (int)palette[i].b << ")" << std::endl;
+        if (fullRedraw || palette[i] != shown[PALETTE_START - GRAPHICS_MEMORY_START + i]) {
+            paletteDirty |= 1u << i;
+        }
+        if (fullRedraw || std::memcmp(tileData + i * 128, shown + (TILE_DATA_START - GRAPHICS_MEMORY_START) + i * 128, 128) != 0) {
+            tileDataDirty |= 1u << i;
         }
     }
 
-    // Render tiles - Focus on first 3x3 for debugging
-    int tiles_rendered = 0;
-    for (int tileY = 0; tileY < TILES_VERTICAL; ++tileY) {
-        for (int tileX = 0; tileX < TILES_HORIZONTAL; ++tileX) {
-            // Get tile index from tile map (0xF000 + row*20 + col)
-            uint16_t mapAddr = 0xF000 + tileY * TILES_HORIZONTAL + tileX;
-            uint8_t tileIndex;
-
-            try {
-                tileIndex = memory->load8(mapAddr);
-
-                // Debug output for first 3x3 tiles only on first frame
-                if (tileY < 3 && tileX < 3 && show_debug) {
-                    std::cout << "Tile at (" << tileX << "," << tileY
-                              << ") addr=0x" << std::hex << mapAddr
-                              << " index=" << std::dec << (int)tileIndex << std::endl;
-                }
-            } catch (const AddressOutOfBoundsException& e) {
-                if (tileY < 3 && tileX < 3 && show_debug) {
-                    std::cout << "ERROR: Cannot read tile map at 0x" << std::hex << mapAddr << std::endl;
-                }
-                continue;
+    // Which tile patterns look different now: their pixels changed, or a
+    // palette entry they use did
+    for (int t = 0; t < 16; ++t) {
+        if (tileDataDirty & (1u << t)) {
+            uint16_t usage = 0;
+            const uint8_t* packedTile = tileData + t * 128;
+            for (int i = 0; i < 128; ++i) {
+                uint8_t packed = packedTile[i];
+                usage |= (1u << (packed & 0x0F)) | (1u << (packed >> 4));
             }
+            tileColorUsage[t] = usage;
+        }
+    }
+    uint16_t patternDirty = tileDataDirty;
+    for (int t = 0; t < 16; ++t) {
+        if (tileColorUsage[t] & paletteDirty) {
+            patternDirty |= 1u << t;
+        }
+    }
 
-            // Only render valid tiles (0-15)
-            if (tileIndex >= 16) {
-                continue;
+    // Expand changed palette entries (0xFA00 - 0xFA0F) into the lookup tables
+    if (paletteDirty) {
+        for (int i = 0; i < 16; ++i) {
+            if (paletteDirty & (1u << i)) {
+                setPaletteEntry(tileLookup, i, palette[i]);
             }
+        }
+        rebuildPairs(tileLookup);
+    }
 
-            tiles_rendered++;
+    if (show_debug) {  // Debug first 5 palette entries only on first frame
+        for (int i = 0; i < 5; ++i) {
+            uint8_t paletteValue = palette[i];
+            sf::Color color = convertPaletteColor(paletteValue);
+            std::cout << "Palette[" << i << "] = 0x" << std::hex << (int)paletteValue
+                      << " -> RGB(" << std::dec << (int)color.r << "," << (int)color.g
+                      << "," << (int)color.b << ")" << std::endl;
+        }
+        std::cout << "Tile rasterizer: " << rasterPathName(rasterPath) << std::endl;
+    }
 
-            // Get tile data start address (0xF200 + tileIndex * 128)
-            uint16_t tileStart = 0xF200 + tileIndex * 128;
+    // Redraw the dirty cells into framePixels
+    int dirtyCells = 0;
+    for (int cell = 0; cell < TOTAL_TILES; ++cell) {
+        uint8_t tileIndex = tileMap[cell];
+        if (fullRedraw || tileIndex != shown[TILE_MAP_START - GRAPHICS_MEMORY_START + cell] || (tileIndex < 16 && (patternDirty & (1u << tileIndex)))) {
+            cellDirty[cell] = true;
+            renderCell(cell, vram);
+            dirtyCells++;
+        }
 
-            if (tileY < 3 && tileX < 3) {
-                std::cout << "Rendering tile " << (int)tileIndex
-                          << " from address 0x" << std::hex << tileStart << std::endl;
-            }
+        if (show_debug && cell % TILES_HORIZONTAL < 3 && cell / TILES_HORIZONTAL < 3) {
+            std::cout << "Tile at (" << cell % TILES_HORIZONTAL << "," << cell / TILES_HORIZONTAL
+                      << ") index=" << (int)tileIndex << std::endl;
+        }
+    }
 
-            // Render each pixel in the 16x16 tile
+    // Upload: one full update when most of the screen changed, otherwise
+    // just the changed 16x16 rectangles
+    if (fullRedraw || dirtyCells > TOTAL_TILES / 2) {
+        screenTexture.update(framePixels.data());
+    } else if (dirtyCells > 0) {
+        for (int cell = 0; cell < TOTAL_TILES; ++cell) {
+            if (!cellDirty[cell]) {
+                continue;
+            }
+            int x0 = (cell % TILES_HORIZONTAL) * TILE_SIZE;
+            int y0 = (cell / TILES_HORIZONTAL) * TILE_SIZE;
             for (int py = 0; py < TILE_SIZE; ++py) {
-                for (int px = 0; px < TILE_SIZE; ++px) {
-                    // Calculate pixel index within tile (row-major order)
-                    int pixelIndex = py * TILE_SIZE + px;
-
-                    // Each byte contains 2 pixels (4 bits each)
-                    int byteOffset = pixelIndex / 2;
-
-                    uint8_t packed;
-                    try {
-                        packed = memory->load8(tileStart + byteOffset);
-                    } catch (const AddressOutOfBoundsException& e) {
-                        continue;
-                    }
-
-                    // Extract 4-bit color index
-                    uint8_t colorIndex;
-                    if (pixelIndex % 2 == 0) {
-                        // Even pixel: lower 4 bits
-                        colorIndex = packed & 0x0F;
-                    } else {
-                        // Odd pixel: upper 4 bits
-                        colorIndex = (packed >> 4) & 0x0F;
-                    }
-
-                    // Debug first pixel of first tile only on first frame
-                    if (tileY == 0 && tileX == 0 && py == 0 && px == 0 && show_debug) {
-                        std::cout << "First pixel: packed=0x" << std::hex << (int)packed
-                                  << " colorIndex=" << std::dec << (int)colorIndex << std::endl;
-                    }
-
-                    // Get color from palette
-                    sf::Color color = palette[colorIndex];
-
-                    // Calculate screen coordinates
-                    int screenX = tileX * TILE_SIZE + px;
-                    int screenY = tileY * TILE_SIZE + py;
-
-                    // Set pixel in screen image
-                    if (screenX < SCREEN_WIDTH && screenY < SCREEN_HEIGHT) {
-                        screenImage.setPixel(screenX, screenY, color);
-                    }
-                }
+                std::memcpy(&cellPixels[py * TILE_SIZE * 4],
+                            &framePixels[((y0 + py) * SCREEN_WIDTH + x0) * 4],
+                            TILE_SIZE * 4);
             }
+            screenTexture.update(cellPixels.data(), TILE_SIZE, TILE_SIZE, x0, y0);
         }
     }
 
     if (show_debug) {
-        std::cout << "Total tiles rendered: " << std::hex << tiles_rendered << std::dec << std::endl;
+        std::cout << "Cells redrawn: " << dirtyCells << std::endl;
     }
 
-    // Update texture and display
-    screenTexture.loadFromImage(screenImage);
-    window.clear();
-    window.draw(screenSprite);
-    window.display();
+    std::memcpy(shownVram.bytes, vram, VRAM_SNAPSHOT_SIZE);
+    std::fill(cellDirty, cellDirty + TOTAL_TILES, false);
+    fullRedraw = false;
 
     static int frameCount = 0;
     frameCount++;
     if (frameCount % 60 == 0) {
         std::cout << "Graphics frame " << frameCount << " complete" << std::endl;
     }
+}
+
+// Draw one 16x16 screen cell into framePixels. Map entries >= 16 are blank.
+void Graphics::renderCell(int cell, const uint8_t* vram) {
+    int tileX = cell % TILES_HORIZONTAL;
+    int tileY = cell / TILES_HORIZONTAL;
+    uint8_t tileIndex = vram[TILE_MAP_START - GRAPHICS_MEMORY_START + cell];
+    sf::Uint8* dst = &framePixels[(tileY * TILE_SIZE * SCREEN_WIDTH + tileX * TILE_SIZE) * 4];
+
+    if (tileIndex < 16) {
+        const uint8_t* packed = vram + (TILE_DATA_START - GRAPHICS_MEMORY_START) + tileIndex * 128;
+        rasterTile(rasterPath, tileLookup, packed, dst, SCREEN_WIDTH * 4);
+    } else {
+        clearTile(dst, SCREEN_WIDTH * 4);
+    }
 }
\ No newline at end of file
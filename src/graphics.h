@@ -2,11 +2,15 @@
 #define GRAPHICS_H
 
 #include <SFML/Graphics.hpp>
+#include <atomic>
+#include <future>
 #include <queue>
-
-// Forward declarations
-class Memory;
-class AddressOutOfBoundsException;
+#include <thread>
+#include <vector>
+#include "memory.h"
+#include "spsc_queue.h"
+#include "tile_raster.h"
+#include "triple_buffer.h"
 
 // Graphics constants
 #define SCREEN_WIDTH 320
@@ -17,8 +21,20 @@ class AddressOutOfBoundsException;
 #define TOTAL_TILES 300
 #define GRAPHICS_MEMORY_START 0xF000
 #define GRAPHICS_MEMORY_END 0xFFFF
+#define TILE_MAP_START 0xF000      // 20x15 tile indices
+#define TILE_MAP_END 0xF12B
+#define TILE_DATA_START 0xF200     // 16 tiles, 128 bytes each (4bpp)
+#define TILE_DATA_END 0xF9FF
+#define PALETTE_START 0xFA00       // 16 RGB332 entries
+#define PALETTE_END 0xFA0F
+#define VRAM_SNAPSHOT_SIZE (PALETTE_END + 1 - GRAPHICS_MEMORY_START)   // tile map .. palette
+
+// Copy of graphics memory 0xF000 - 0xFA0F handed to the render thread
+struct VramSnapshot {
+    uint8_t bytes[VRAM_SNAPSHOT_SIZE];
+};
 
-class Graphics {
+class Graphics : public MmioDevice {
 private:
     Memory* memory;
     bool needsUpdate;
@@ -27,6 +43,16 @@ private:
     // NEW: Keyboard input handling
     uint16_t lastKeyPressed;
     bool hasNewKeyPress;
+    SpscQueue<uint16_t, 64> keyEvents;   // event thread -> simulator thread
+
+    // Render thread: owns the window, polls events and draws the newest
+    // published snapshot; the simulator thread only copies VRAM into it
+    bool threaded;
+    bool vramWritten;                  // VRAM stored to since the last publish
+    TripleBuffer<VramSnapshot> snapshots;
+    std::thread renderThread;
+    std::atomic<bool> stopRendering;
+    std::atomic<bool> windowOpen;
 
     // SFML graphics objects
     sf::Image screenImage;
@@ -44,6 +70,24 @@ private:
     bool keyPressed;
     char lastKey;
 
+    // Dirty tracking: each snapshot is diffed against the one on screen and
+    // only the 16x16 cells that look different are redrawn
+    VramSnapshot shownVram;           // contents of the texture
+    bool cellDirty[TOTAL_TILES];
+    bool fullRedraw;                  // first frame, or the texture was recreated
+    uint16_t tileColorUsage[16];      // bit c: tile pattern uses palette entry c
+    std::vector<sf::Uint8> framePixels;   // RGBA copy of the texture contents
+    std::vector<sf::Uint8> cellPixels;    // one 16x16 cell for sf::Texture::update
+
+    TileLookup tileLookup;            // palette and byte -> pixel-pair tables
+    RasterPath rasterPath;
+
+    bool createWindow();
+    void renderLoop(std::promise<bool>* ready);
+    void renderSnapshot(const uint8_t* vram);
+    void presentFrame();
+    void renderCell(int cell, const uint8_t* vram);
+
     // Helper method to convert SFML key to ASCII/key code
     uint16_t convertSFMLKeyToCode(sf::Keyboard::Key key) const;
 
@@ -51,16 +95,29 @@ public:
     Graphics(Memory* mem);
     ~Graphics();
 
-    // Core graphics methods
-    bool initialize();
+    // Core graphics methods. With a render thread, update() just publishes
+    // a VRAM snapshot and the window lives on that thread.
+    bool initialize(bool useRenderThread = true);
     bool isWindowOpen();
     void handleEvents();
     void markDirty();
     void update();
-    void renderFrame();
+    void renderFrame();    // synchronous render of current memory
+    void shutdown();
+
+    // RGBA, SCREEN_WIDTH x SCREEN_HEIGHT, as of the last rendered frame
+    const sf::Uint8* getFramePixels() const { return framePixels.data(); }
+
+    // Tile rasterizer (defaults to the best one the CPU supports)
+    void setRasterPath(RasterPath path);
+    RasterPath getRasterPath() const { return rasterPath; }
+
+    // Tile map, tile data and palette stores schedule a redraw
+    void onMmioWrite(uint16_t addr, uint16_t value, uint32_t size) override;
 
-    // NEW: Keyboard input methods (for ECALL 7)
-    uint16_t getLastKeyPressed() const;
+    // NEW: Keyboard input methods (for ECALL 7). Key presses queued by the
+    // event thread are drained here; the newest one wins.
+    uint16_t getLastKeyPressed();
     void clearLastKeyPressed();
     bool isKeyCurrentlyPressed(sf::Keyboard::Key key) const;
 
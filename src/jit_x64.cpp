@@ -0,0 +1,511 @@
+#include "jit_x64.h"
+#include "block_cache.h"
+#include <cstring>
+#include <exception>
+#include <vector>
+
+#if ZX16_JIT_X64
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+typedef uint32_t (*JitEntry)(JitFrame* frame);
+
+// Slow-path state for the block currently running natively
+struct JitRuntime {
+    ExecContext* ctx;
+    TranslatedBlock* block;
+    std::exception_ptr fault;
+};
+
+// Slow-path return codes
+enum {
+    SLOW_CONTINUE = 0,
+    SLOW_EXIT = 1,     // halted, or the block overwrote itself
+    SLOW_FAULT = 2     // the handler threw; the exception is in JitRuntime::fault
+};
+
+// Called from generated code with every ZX16 register spilled to Registers.
+// Runs the interpreter handler for ops[index] of the running block.
+static uint32_t jitSlowPath(JitFrame* frame, uint32_t index) {
+    JitRuntime* rt = static_cast<JitRuntime*>(frame->runtime);
+    TranslatedBlock& block = *rt->block;
+    const PredecodedInstruction& op = block.ops[index];
+    ExecContext& ctx = *rt->ctx;
+
+    ctx.pc = static_cast<uint16_t>(block.startPc + index * 2 + 2);
+    try {
+        ALU::handlers()[op.op](op, ctx);
+    } catch (...) {
+        // C++ exceptions cannot unwind through generated code
+        rt->fault = std::current_exception();
+        return SLOW_FAULT;
+    }
+    return (ctx.halted || !block.valid) ? SLOW_EXIT : SLOW_CONTINUE;
+}
+
+#if ZX16_JIT_X64
+
+namespace {
+
+enum HostReg { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7 };
+
+// ZX16 xN lives in r(8+N); rbp holds the JitFrame, rbx the memory base
+inline int zx(int reg) { return 8 + (reg & 7); }
+
+#ifdef _WIN32
+const int ARG0 = RCX, ARG1 = RDX;
+#else
+const int ARG0 = RDI, ARG1 = RSI;
+#endif
+
+enum Cond { CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_A = 0x7, CC_L = 0xC, CC_GE = 0xD };
+
+// Group-1 /digit and shift /digit extensions
+enum { EXT_ADD = 0, EXT_OR = 1, EXT_AND = 4, EXT_SUB = 5, EXT_XOR = 6, EXT_CMP = 7 };
+enum { EXT_SHL = 4, EXT_SHR = 5, EXT_SAR = 7 };
+
+const uint8_t OFF_REGS = offsetof(JitFrame, regs);
+const uint8_t OFF_MEMORY = offsetof(JitFrame, memory);
+const uint8_t OFF_PAGE_FLAGS = offsetof(JitFrame, pageFlags);
+const uint8_t OFF_PC = offsetof(JitFrame, pc);
+
+// Minimal x86-64 encoder; 32-bit operations unless the name says otherwise
+class Emitter {
+public:
+    std::vector<uint8_t> code;
+
+    void byte(uint8_t b) { code.push_back(b); }
+    void dword(uint32_t v) { for (int i = 0; i < 4; ++i) byte(static_cast<uint8_t>(v >> (i * 8))); }
+    void qword(uint64_t v) { for (int i = 0; i < 8; ++i) byte(static_cast<uint8_t>(v >> (i * 8))); }
+
+    void rex(bool w, int reg, int rm) {
+        uint8_t r = 0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+        if (r != 0x40) byte(r);
+    }
+    void modrm(int mod, int reg, int rm) { byte(static_cast<uint8_t>((mod << 6) | ((reg & 7) << 3) | (rm & 7))); }
+
+    // op r/m32, r32 (ADD 01, OR 09, AND 21, SUB 29, XOR 31, CMP 39, MOV 89)
+    void aluRR(uint8_t opcode, int dst, int src) { rex(false, src, dst); byte(opcode); modrm(3, src, dst); }
+    void mov(int dst, int src) { aluRR(0x89, dst, src); }
+    void mov64(int dst, int src) { rex(true, src, dst); byte(0x89); modrm(3, src, dst); }
+    void movImm(int dst, uint32_t imm) { rex(false, 0, dst); byte(static_cast<uint8_t>(0xB8 + (dst & 7))); dword(imm); }
+    void movImm64(int dst, uint64_t imm) { rex(true, 0, dst); byte(static_cast<uint8_t>(0xB8 + (dst & 7))); qword(imm); }
+    void aluImm(int ext, int dst, uint32_t imm) { rex(false, 0, dst); byte(0x81); modrm(3, ext, dst); dword(imm); }
+
+    // movzx/movsx dst, src16
+    void zext16(int dst, int src) { rex(false, dst, src); byte(0x0F); byte(0xB7); modrm(3, dst, src); }
+    void sext16(int dst, int src) { rex(false, dst, src); byte(0x0F); byte(0xBF); modrm(3, dst, src); }
+
+    void shiftCl(int ext, int dst) { rex(false, 0, dst); byte(0xD3); modrm(3, ext, dst); }
+    void shiftImm(int ext, int dst, uint8_t n) { rex(false, 0, dst); byte(0xC1); modrm(3, ext, dst); byte(n); }
+
+    // setcc al; movzx dst, al
+    void setcc(int cc, int dst) {
+        byte(0x0F); byte(static_cast<uint8_t>(0x90 | cc)); modrm(3, 0, RAX);
+        rex(false, dst, RAX); byte(0x0F); byte(0xB6); modrm(3, dst, RAX);
+    }
+
+    void testAlImm(uint8_t imm) { byte(0xA8); byte(imm); }
+
+    // Frame fields: [rbp + disp8]
+    void loadFrame64(int dst, uint8_t disp) { rex(true, dst, RBP); byte(0x8B); modrm(1, dst, RBP); byte(disp); }
+    void storeFrame32(uint8_t disp, int src) { rex(false, src, RBP); byte(0x89); modrm(1, src, RBP); byte(disp); }
+    void storeFrameImm32(uint8_t disp, uint32_t imm) { byte(0xC7); modrm(1, 0, RBP); byte(disp); dword(imm); }
+
+    // Register file: [rdx + 2 * index]
+    void spillReg(int index) { byte(0x66); rex(false, zx(index), RDX); byte(0x89); modrm(1, zx(index), RDX); byte(static_cast<uint8_t>(index * 2)); }
+    void reloadReg(int index) { rex(false, zx(index), RDX); byte(0x0F); byte(0xB7); modrm(1, zx(index), RDX); byte(static_cast<uint8_t>(index * 2)); }
+
+    // Guest memory: [rbx + rax]
+    void loadMem16(int dst) { rex(false, dst, RAX); byte(0x0F); byte(0xB7); modrm(0, dst, RSP); byte(0x03); }
+    void loadMem8Signed(int dst) { rex(false, dst, RAX); byte(0x0F); byte(0xBE); modrm(0, dst, RSP); byte(0x03); }
+    void loadMem8(int dst) { rex(false, dst, RAX); byte(0x0F); byte(0xB6); modrm(0, dst, RSP); byte(0x03); }
+    void storeMem16(int src) { byte(0x66); rex(false, src, RAX); byte(0x89); modrm(0, src, RSP); byte(0x03); }
+
+    // test byte [rdx + rcx], imm8
+    void testFlagByte(uint8_t imm) { byte(0xF6); modrm(0, 0, RSP); byte(0x0A); byte(imm); }
+
+    void push(int reg) { rex(false, 0, reg); byte(static_cast<uint8_t>(0x50 + (reg & 7))); }
+    void pop(int reg) { rex(false, 0, reg); byte(static_cast<uint8_t>(0x58 + (reg & 7))); }
+    void callRax() { byte(0xFF); byte(0xD0); }
+
+    // Forward jumps: return the rel32 position to bind() later
+    size_t jcc(int cc) { byte(0x0F); byte(static_cast<uint8_t>(0x80 | cc)); dword(0); return code.size() - 4; }
+    size_t jmp() { byte(0xE9); dword(0); return code.size() - 4; }
+    void bind(size_t at) { bindTo(at, code.size()); }
+    void bindTo(size_t at, size_t target) {
+        uint32_t rel = static_cast<uint32_t>(target - (at + 4));
+        std::memcpy(&code[at], &rel, 4);
+    }
+};
+
+// Generates one native function per TranslatedBlock
+class BlockCompiler {
+public:
+    explicit BlockCompiler(const TranslatedBlock& block) : block(block) {}
+
+    std::vector<uint8_t>& compile() {
+        prologue();
+        for (uint32_t i = 0; i < block.ops.size(); ++i) {
+            instruction(i);
+        }
+        // Ran off the end without a terminator (length cap or an ECALL next)
+        if (block.ops.empty() || !terminated) {
+            exitTo(static_cast<uint16_t>(block.endPc), static_cast<uint32_t>(block.ops.size()));
+        }
+        epilogue();
+        return e.code;
+    }
+
+private:
+    const TranslatedBlock& block;
+    Emitter e;
+    std::vector<size_t> exits;
+    bool terminated = false;
+
+    uint16_t pcOf(uint32_t i) const { return static_cast<uint16_t>(block.startPc + i * 2); }
+
+    void prologue() {
+        e.push(RBX); e.push(RBP);
+        e.push(12); e.push(13); e.push(14); e.push(15);
+        // 6 pushes + return address: 40 more bytes keeps rsp 16-aligned and
+        // covers the Win64 shadow space
+        e.byte(0x48); e.byte(0x83); e.byte(0xEC); e.byte(40);
+        e.mov64(RBP, ARG0);
+        e.loadFrame64(RBX, OFF_MEMORY);
+        reloadAll();
+    }
+
+    void epilogue() {
+        for (size_t at : exits) {
+            e.bind(at);
+        }
+        spillAll();
+        e.byte(0x48); e.byte(0x83); e.byte(0xC4); e.byte(40);
+        e.pop(15); e.pop(14); e.pop(13); e.pop(12);
+        e.pop(RBP); e.pop(RBX);
+        e.byte(0xC3);
+    }
+
+    void spillAll() {
+        e.loadFrame64(RDX, OFF_REGS);
+        for (int r = 0; r < 8; ++r) e.spillReg(r);
+    }
+
+    void reloadAll() {
+        e.loadFrame64(RDX, OFF_REGS);
+        for (int r = 0; r < 8; ++r) e.reloadReg(r);
+    }
+
+    // Leave the block: eax = instructions retired, frame->pc = next PC
+    void exitTo(uint16_t pc, uint32_t count) {
+        e.storeFrameImm32(OFF_PC, pc);
+        e.movImm(RAX, count);
+        exits.push_back(e.jmp());
+    }
+
+    void exitToReg(int reg, uint32_t count) {
+        e.storeFrame32(OFF_PC, reg);
+        e.movImm(RAX, count);
+        exits.push_back(e.jmp());
+    }
+
+    // Run ops[i] through the interpreter handler
+    void slowPath(uint32_t i) {
+        spillAll();
+        e.mov64(ARG0, RBP);
+        e.movImm(ARG1, i);
+        e.movImm64(RAX, reinterpret_cast<uint64_t>(&jitSlowPath));
+        e.callRax();
+        reloadAll();
+
+        e.aluRR(0x85, RAX, RAX);            // test eax, eax
+        size_t cont = e.jcc(CC_E);
+        e.aluImm(EXT_CMP, RAX, SLOW_FAULT);
+        size_t fault = e.jcc(CC_E);
+        exitTo(static_cast<uint16_t>(pcOf(i) + 2), i + 1);
+        e.bind(fault);
+        exitTo(pcOf(i), i);
+        e.bind(cont);
+    }
+
+    // eax = (base + imm) & 0xFFFF
+    void address(int base, int16_t imm) {
+        e.mov(RAX, zx(base));
+        e.aluImm(EXT_ADD, RAX, static_cast<uint16_t>(imm));
+        e.zext16(RAX, RAX);
+    }
+
+    // rd = eax & 0xFFFF
+    void writeBack(int rd) { e.zext16(zx(rd), RAX); }
+
+    void binary(uint8_t opcode, const PredecodedInstruction& p) {
+        e.mov(RAX, zx(p.rs1));
+        e.aluRR(opcode, RAX, zx(p.rs2));
+        writeBack(p.rd);
+    }
+
+    void immediate(int ext, const PredecodedInstruction& p) {
+        e.mov(RAX, zx(p.rs1));
+        e.aluImm(ext, RAX, static_cast<uint16_t>(p.imm));
+        writeBack(p.rd);
+    }
+
+    // Shift amount in ecx (already masked for immediates)
+    void shiftByCl(int ext, const PredecodedInstruction& p) {
+        e.mov(RCX, zx(p.rs2));
+        e.aluImm(EXT_AND, RCX, 0xF);
+        if (ext == EXT_SAR) e.sext16(RAX, zx(p.rs1)); else e.mov(RAX, zx(p.rs1));
+        e.shiftCl(ext, RAX);
+        writeBack(p.rd);
+    }
+
+    void shiftByImm(int ext, const PredecodedInstruction& p) {
+        if (ext == EXT_SAR) e.sext16(RAX, zx(p.rs1)); else e.mov(RAX, zx(p.rs1));
+        e.shiftImm(ext, RAX, static_cast<uint8_t>(p.imm & 0xF));
+        writeBack(p.rd);
+    }
+
+    void signedCompare(int a, int b) {
+        e.sext16(RAX, zx(a));
+        e.sext16(RCX, zx(b));
+        e.aluRR(0x39, RAX, RCX);
+    }
+
+    void branch(int cc, uint32_t i, const PredecodedInstruction& p) {
+        size_t taken = e.jcc(cc);
+        exitTo(static_cast<uint16_t>(pcOf(i) + 2), i + 1);
+        e.bind(taken);
+        exitTo(static_cast<uint16_t>(pcOf(i) + 2 + p.imm), i + 1);
+        terminated = true;
+    }
+
+    void instruction(uint32_t i) {
+        const PredecodedInstruction& p = block.ops[i];
+        uint16_t pc = pcOf(i);
+
+        switch (p.op) {
+            case OP_ADD:  binary(0x01, p); break;
+            case OP_SUB:  binary(0x29, p); break;
+            case OP_AND:  binary(0x21, p); break;
+            case OP_OR:   binary(0x09, p); break;
+            case OP_XOR:  binary(0x31, p); break;
+            case OP_SLT:  signedCompare(p.rs1, p.rs2); e.setcc(CC_L, zx(p.rd)); break;
+            case OP_SLTU: e.aluRR(0x39, zx(p.rs1), zx(p.rs2)); e.setcc(CC_B, zx(p.rd)); break;
+            case OP_SLL:  shiftByCl(EXT_SHL, p); break;
+            case OP_SRL:  shiftByCl(EXT_SHR, p); break;
+            case OP_SRA:  shiftByCl(EXT_SAR, p); break;
+            case OP_MV:   e.mov(zx(p.rd), zx(p.rs2)); break;
+            case OP_UNKNOWN_R: e.movImm(zx(p.rd), 0); break;
+
+            case OP_JR:
+                exitToReg(zx(p.rd), i + 1);
+                terminated = true;
+                break;
+            case OP_JALR:
+                // Read the target before rd may overwrite it
+                e.mov(RCX, zx(p.rs2));
+                e.movImm(zx(p.rd), static_cast<uint16_t>(pc + 2));
+                exitToReg(RCX, i + 1);
+                terminated = true;
+                break;
+
+            case OP_ADDI: immediate(EXT_ADD, p); break;
+            case OP_ORI:  immediate(EXT_OR, p); break;
+            case OP_ANDI: immediate(EXT_AND, p); break;
+            case OP_XORI: immediate(EXT_XOR, p); break;
+            case OP_SLTI:
+                e.sext16(RAX, zx(p.rs1));
+                e.aluImm(EXT_CMP, RAX, static_cast<uint32_t>(static_cast<int32_t>(p.imm)));
+                e.setcc(CC_L, zx(p.rd));
+                break;
+            case OP_SLTUI:
+                e.aluImm(EXT_CMP, zx(p.rs1), static_cast<uint16_t>(p.imm));
+                e.setcc(CC_B, zx(p.rd));
+                break;
+            case OP_SLLI: shiftByImm(EXT_SHL, p); break;
+            case OP_SRLI: shiftByImm(EXT_SHR, p); break;
+            case OP_SRAI: shiftByImm(EXT_SAR, p); break;
+            case OP_LI:
+            case OP_LUI:
+                e.movImm(zx(p.rd), static_cast<uint16_t>(p.imm));
+                break;
+            case OP_AUIPC:
+                e.movImm(zx(p.rd), static_cast<uint16_t>(pc + p.imm));
+                break;
+
+            case OP_BEQ:  e.aluRR(0x39, zx(p.rs1), zx(p.rs2)); branch(CC_E, i, p); break;
+            case OP_BNE:  e.aluRR(0x39, zx(p.rs1), zx(p.rs2)); branch(CC_NE, i, p); break;
+            case OP_BZ:   e.aluImm(EXT_CMP, zx(p.rs1), 0); branch(CC_E, i, p); break;
+            case OP_BNZ:  e.aluImm(EXT_CMP, zx(p.rs1), 0); branch(CC_NE, i, p); break;
+            case OP_BLT:  signedCompare(p.rs1, p.rs2); branch(CC_L, i, p); break;
+            case OP_BGE:  signedCompare(p.rs1, p.rs2); branch(CC_GE, i, p); break;
+            case OP_BLTU: e.aluRR(0x39, zx(p.rs1), zx(p.rs2)); branch(CC_B, i, p); break;
+            case OP_BGEU: e.aluRR(0x39, zx(p.rs1), zx(p.rs2)); branch(CC_AE, i, p); break;
+
+            case OP_J:
+            case OP_JAL:
+                if (p.rd != 0) {
+                    e.movImm(zx(p.rd), static_cast<uint16_t>(pc + 2));
+                }
+                exitTo(static_cast<uint16_t>(pc + p.imm), i + 1);
+                terminated = true;
+                break;
+
+            // Loads: RAM inline, MMIO and misaligned words through the handler
+            case OP_LW:
+            case OP_LB:
+            case OP_LBU: {
+                address(p.rs2, p.imm);
+                size_t odd = 0;
+                if (p.op == OP_LW) {
+                    e.testAlImm(1);
+                    odd = e.jcc(CC_NE);
+                }
+                e.aluImm(EXT_CMP, RAX, MMIO_START - 1);
+                size_t mmio = e.jcc(CC_A);
+                if (p.op == OP_LW) {
+                    e.loadMem16(zx(p.rd));
+                } else if (p.op == OP_LB) {
+                    e.loadMem8Signed(RAX);
+                    writeBack(p.rd);
+                } else {
+                    e.loadMem8(zx(p.rd));
+                }
+                size_t done = e.jmp();
+                if (p.op == OP_LW) e.bind(odd);
+                e.bind(mmio);
+                slowPath(i);
+                e.bind(done);
+                break;
+            }
+
+            // SW: RAM inline unless the page holds code; SB always logs, so it
+            // stays in the handler
+            case OP_SW: {
+                address(p.rs1, p.imm);
+                e.testAlImm(1);
+                size_t odd = e.jcc(CC_NE);
+                e.aluImm(EXT_CMP, RAX, MMIO_START - 1);
+                size_t mmio = e.jcc(CC_A);
+                e.mov(RCX, RAX);
+                e.shiftImm(EXT_SHR, RCX, MEMORY_PAGE_SHIFT);
+                e.loadFrame64(RDX, OFF_PAGE_FLAGS);
+                e.testFlagByte(PAGE_CODE);
+                size_t code = e.jcc(CC_NE);
+                e.storeMem16(zx(p.rs2));
+                size_t done = e.jmp();
+                e.bind(odd);
+                e.bind(mmio);
+                e.bind(code);
+                slowPath(i);
+                e.bind(done);
+                break;
+            }
+            case OP_SB:
+                slowPath(i);
+                break;
+
+            case OP_UNKNOWN_S:
+            case OP_UNKNOWN_L:
+                break;
+
+            default:
+                // ECALL/unknown SYS never reach a block; anything else halts in the handler
+                slowPath(i);
+                break;
+        }
+    }
+};
+
+} // namespace
+
+JitCompiler::JitCompiler()
+    : arena(nullptr), used(0), generation(1), compiled(0), flushes(0) {
+#ifdef _WIN32
+    void* mem = VirtualAlloc(nullptr, ARENA_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+    arena = static_cast<uint8_t*>(mem);
+#else
+    void* mem = mmap(nullptr, ARENA_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    arena = (mem == MAP_FAILED) ? nullptr : static_cast<uint8_t*>(mem);
+#endif
+}
+
+JitCompiler::~JitCompiler() {
+    if (!arena) {
+        return;
+    }
+#ifdef _WIN32
+    VirtualFree(arena, 0, MEM_RELEASE);
+#else
+    munmap(arena, ARENA_SIZE);
+#endif
+}
+
+bool JitCompiler::compile(TranslatedBlock& block) {
+    if (!arena) {
+        return false;
+    }
+
+    BlockCompiler compiler(block);
+    std::vector<uint8_t>& code = compiler.compile();
+    if (code.size() > ARENA_SIZE) {
+        return false;
+    }
+    if (used + code.size() > ARENA_SIZE) {
+        // Recycle the whole arena; older blocks fall back until recompiled
+        used = 0;
+        generation++;
+        flushes++;
+    }
+
+    std::memcpy(arena + used, code.data(), code.size());
+    block.native = arena + used;
+    block.nativeGeneration = generation;
+    used += (code.size() + 15) & ~static_cast<size_t>(15);
+    compiled++;
+    return true;
+}
+
+#else // !ZX16_JIT_X64
+
+JitCompiler::JitCompiler()
+    : arena(nullptr), used(0), generation(1), compiled(0), flushes(0) {}
+
+JitCompiler::~JitCompiler() {}
+
+bool JitCompiler::compile(TranslatedBlock&) {
+    return false;
+}
+
+#endif // ZX16_JIT_X64
+
+bool JitCompiler::hasNative(const TranslatedBlock& block) const {
+    return block.native != nullptr && block.nativeGeneration == generation;
+}
+
+uint32_t JitCompiler::execute(TranslatedBlock& block, ExecContext& ctx) {
+    JitRuntime rt;
+    rt.ctx = &ctx;
+    rt.block = &block;
+
+    JitFrame frame;
+    frame.regs = ctx.regs.data();
+    frame.memory = ctx.mem.hostData();
+    frame.pageFlags = ctx.mem.hostPageFlags();
+    frame.runtime = &rt;
+    frame.pc = block.startPc;
+
+    JitEntry entry = reinterpret_cast<JitEntry>(block.native);
+    uint32_t retired = entry(&frame);
+    ctx.pc = static_cast<uint16_t>(frame.pc);
+
+    if (rt.fault) {
+        std::rethrow_exception(rt.fault);
+    }
+    return retired;
+}
@@ -0,0 +1,66 @@
+#ifndef JIT_X64_H
+#define JIT_X64_H
+
+#include <cstdint>
+#include <cstddef>
+#include "alu.h"
+
+// Native code generation only exists for x86-64 hosts; elsewhere the JIT
+// reports itself unavailable and the block interpreter is used.
+#if defined(__x86_64__) || defined(_M_X64)
+#define ZX16_JIT_X64 1
+#else
+#define ZX16_JIT_X64 0
+#endif
+
+struct TranslatedBlock;
+
+// Passed to every compiled block. The generated code addresses these fields
+// by offset, so keep it plain data.
+struct JitFrame {
+    uint16_t* regs;              // Registers storage (x0-x7)
+    uint8_t* memory;             // Memory storage, 64KB
+    const uint8_t* pageFlags;    // Memory page flags, PAGE_CODE forces the slow path
+    void* runtime;               // slow-path state, owned by JitCompiler::execute()
+    uint32_t pc;                 // PC after the block exits
+};
+
+// Compiles hot translated blocks to x86-64. Inside a block the eight ZX16
+// registers live in r8-r15; loads and stores that touch MMIO or a code page,
+// misaligned word accesses and SB fall back to the ALU handler for that
+// instruction. Blocks never contain an ECALL (see BlockCache).
+class JitCompiler {
+public:
+    static const uint32_t HOT_THRESHOLD = 16;          // block executions before compiling
+    static const size_t ARENA_SIZE = 4 * 1024 * 1024;   // executable code buffer
+
+    JitCompiler();
+    ~JitCompiler();
+
+    // False on non-x86-64 hosts or if no executable memory could be mapped
+    bool isAvailable() const { return arena != nullptr; }
+
+    bool hasNative(const TranslatedBlock& block) const;
+
+    // Generate native code for block; false if the JIT is unavailable
+    bool compile(TranslatedBlock& block);
+
+    // Run the native code for one block and return the instructions retired.
+    // ctx.pc ends at the next PC, or at the faulting instruction when a slow
+    // path throws (the exception is rethrown here).
+    uint32_t execute(TranslatedBlock& block, ExecContext& ctx);
+
+    // Statistics
+    uint64_t getCompiledCount() const { return compiled; }
+    uint64_t getFlushCount() const { return flushes; }
+    size_t getCodeBytes() const { return used; }
+
+private:
+    uint8_t* arena;
+    size_t used;
+    uint32_t generation;    // bumped when the arena is recycled
+    uint64_t compiled;
+    uint64_t flushes;
+};
+
+#endif // JIT_X64_H
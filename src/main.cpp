@@ -3,15 +3,19 @@
 #include <vector>
 #include <iomanip>
 #include <limits>
+#include <cstdlib>
 #include <chrono>
 #include <thread>
-#include "Decoder.h"
-#include "Registers.h"
-#include "Memory.h"
-#include "Graphics.h"
-#include "Ecalls.h"
+#include "decoder.h"
+#include "registers.h"
+#include "memory.h"
+#include "graphics.h"
+#include "ecalls.h"
 #include "alu.h"
 #include "DataLoader.h"
+#include "predecode.h"
+#include "simulator.h"
+#include "decode_table.h"
 
 using namespace std;
 
@@ -34,72 +38,6 @@ std::vector<uint16_t> readBinaryFile(const std::string& filename) {
     return instructions;
 }
 
-std::string formatInstruction(const DecodedInstruction& d) {
-    std::string result = d.mnemonic;
-
-    // Check for NOP (ADD x0, x0, x0)
-    if (d.format == FORMAT_R && d.mnemonic == "ADD" && d.rd == 0 && d.rs1 == 0 && d.rs2 == 0) {
-        return "NOP";
-    }
-
-    switch (d.format) {
-        case FORMAT_R:
-            if (d.mnemonic == "MV") {
-                result += " x" + std::to_string(d.rd) + ", x" + std::to_string(d.rs2);
-            }
-            else if (d.mnemonic == "JR") {
-                result += " x" + std::to_string(d.rd);
-            }
-            else if (d.mnemonic == "JALR") {
-                result += " x" + std::to_string(d.rd) + ", x" + std::to_string(d.rs2);
-            }
-            else {
-                result += " x" + std::to_string(d.rd) + ", x" + std::to_string(d.rs2);
-            }
-            break;
-
-        case FORMAT_I:
-            result += " x" + std::to_string(d.rd) + ", " + std::to_string(d.imm);
-            break;
-
-        case FORMAT_S:
-            result += " x" + std::to_string(d.rs2) + ", " + std::to_string(d.imm) + "(x" + std::to_string(d.rs1) + ")";
-            break;
-
-        case FORMAT_L:
-            result += " x" + std::to_string(d.rd) + ", " + std::to_string(d.imm) + "(x" + std::to_string(d.rs2) + ")";
-            break;
-
-        case FORMAT_B:
-            if (d.mnemonic == "BZ" || d.mnemonic == "BNZ") {
-                result += " x" + std::to_string(d.rs1) + ", " + std::to_string(d.imm);
-            } else {
-                result += " x" + std::to_string(d.rs1) + ", x" + std::to_string(d.rs2) + ", " + std::to_string(d.imm);
-            }
-            break;
-
-        case FORMAT_J:
-            if (d.rd != 0) {
-                result += " x" + std::to_string(d.rd) + ", " + std::to_string(d.imm);
-            } else {
-                result += " " + std::to_string(d.imm);
-            }
-            break;
-
-        case FORMAT_U:
-            result += " x" + std::to_string(d.rd) + ", " + std::to_string(d.imm);
-            break;
-
-        case FORMAT_SYS:
-            if (d.sys_op == SYSOP_ECALL) {
-                result += " " + std::to_string(d.imm);
-            }
-            break;
-    }
-
-    return result;
-}
-
 void setupGraphicsDemo(Memory& mem) {
     std::cout << "Setting up graphics demo with visible colors..." << std::endl;
 
@@ -167,17 +105,107 @@ void setupGraphicsDemo(Memory& mem) {
     std::cout << "Expected: 4 vertical color stripes - Red, Blue, Green, Yellow" << std::endl;
 }
 
-int main() {
-    Decoder decoder;
+static void printUsage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options] [program.bin]" << std::endl;
+    std::cout << "  --headless             run without a window at full host speed" << std::endl;
+    std::cout << "  --turbo                keep the window but drop the per-instruction delay" << std::endl;
+    std::cout << "  --frame-interval N     sample graphics/events every N instructions" << std::endl;
+    std::cout << "  --frame-on-mmio        also sample after each write to 0xF000-0xFFFF" << std::endl;
+    std::cout << "  --max-instructions N   stop after N instructions (0 = no limit)" << std::endl;
+    std::cout << "  --no-loop-detect       do not stop on a PC that repeats 1000 times" << std::endl;
+    std::cout << "  --engine step|blocks|jit  execution engine (turbo/headless default: blocks)" << std::endl;
+    std::cout << "  --no-render-thread     draw and poll events on the simulator thread" << std::endl;
+    std::cout << "  --verify-decode-table  check all 65536 decode table entries against the decoder" << std::endl;
+}
+
+// Parse a non-negative integer option value; returns false on junk
+static bool parseCount(const char* text, uint64_t& value) {
+    char* end = nullptr;
+    unsigned long long parsed = std::strtoull(text, &end, 0);
+    if (end == text || *end != '\0') {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+static bool parseEngine(const std::string& name, int& engine) {
+    if (name == "step") engine = ENGINE_STEP;
+    else if (name == "blocks") engine = ENGINE_BLOCKS;
+    else if (name == "jit") engine = ENGINE_JIT;
+    else return false;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string programPath = "C:/Users/ASUS/Desktop/z16-fork/assembler/video.bin";
+    RunOptions options;
+    bool turbo = false;
+    bool frameIntervalSet = false;
+    bool maxInstructionsSet = false;
+    int engine = -1;
+    bool renderThread = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        uint64_t value = 0;
+
+        if (arg == "--headless") {
+            options.headless = true;
+            turbo = true;
+        } else if (arg == "--turbo") {
+            turbo = true;
+        } else if (arg == "--frame-interval" && i + 1 < argc && parseCount(argv[i + 1], value) && value > 0) {
+            options.frameInterval = static_cast<uint32_t>(value);
+            frameIntervalSet = true;
+            ++i;
+        } else if (arg == "--frame-on-mmio") {
+            options.frameOnMmioWrite = true;
+        } else if (arg == "--max-instructions" && i + 1 < argc && parseCount(argv[i + 1], value)) {
+            options.maxInstructions = value;
+            maxInstructionsSet = true;
+            ++i;
+        } else if (arg == "--no-loop-detect") {
+            options.detectLoops = false;
+        } else if (arg == "--engine" && i + 1 < argc && parseEngine(argv[i + 1], engine)) {
+            ++i;
+        } else if (arg == "--no-render-thread") {
+            renderThread = false;
+        } else if (arg == "--verify-decode-table") {
+            return verifyDecodeTable(std::cout) == 0 ? 0 : 1;
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] != '-') {
+            programPath = arg;
+        } else {
+            std::cerr << "Unknown or incomplete option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (turbo) {
+        // ~60 samples per second of emulated time at a few MIPS
+        options.setTurbo(frameIntervalSet ? options.frameInterval : 50000);
+        if (options.headless && !maxInstructionsSet) {
+            options.maxInstructions = 0;
+        }
+    }
+    if (engine >= 0) {
+        options.engine = static_cast<ExecutionEngine>(engine);
+    }
+
     Registers regs;
     Memory mem;
     Graphics gfx(&mem);
     Ecalls ecalls;
     ALU alu;
     DataSection dataSection;
+    PredecodeCache predecode(mem);
 
-    // Initialize graphics system
-    if (!gfx.initialize()) {
+    // Initialize graphics system (batch servers have no display)
+    if (!options.headless && !gfx.initialize(renderThread)) {
         std::cerr << "Failed to initialize graphics system!" << std::endl;
         return 1;
     }
@@ -194,7 +222,6 @@ int main() {
         mem.store8(0xFA00 + i, 0x00);  // Black for unused colors
     }
 
-    std::string programPath = "C:/Users/ASUS/Desktop/z16-fork/assembler/video.bin";
     std::vector<uint16_t> instructions = readBinaryFile(programPath);
 
     if (instructions.empty()) {
@@ -206,90 +233,30 @@ int main() {
 
     // Load instructions into memory starting at 0x0000
     for (size_t i = 0; i < instructions.size(); ++i) {
-        mem.store16(i * 2, instructions[i]);
+        mem.writeHalfWord(i * 2, instructions[i]);
     }
 
-    uint16_t pc = 0;
-    bool halted = false;
-    int instruction_count = 0;
-    int loop_detection_count = 0;
-    uint16_t last_pc = 0xFFFF;
-
     std::cout << "\n" << std::string(50, '=') << std::endl;
     std::cout << "         REAL ZX16 INSTRUCTION SIMULATION" << std::endl;
     std::cout << std::string(50, '=') << std::endl;
     std::cout << "\nRunning ZX16 assembly program..." << std::endl;
-    std::cout << "Graphics will be created by simulated ZX16 instructions." << std::endl;
-
-    while (!halted && gfx.isWindowOpen()) {
-        uint16_t inst = mem.load16(pc);
-        DecodedInstruction d = decoder.decode(inst);
-
-        // Check if this is a NOP and skip display if desired
-        bool is_nop = (d.format == FORMAT_R && d.mnemonic == "ADD" && d.rd == 0 && d.rs1 == 0 && d.rs2 == 0);
-
-        // Show first 20 instructions for debugging
-        if (!is_nop && instruction_count < 20) {
-            std::string formatted = formatInstruction(d);
-            std::cout << std::hex << std::setw(4) << std::setfill('0') << pc << ": " << formatted << std::endl;
-        }
-
-        // Detect infinite loops
-        if (pc == last_pc) {
-            loop_detection_count++;
-            if (loop_detection_count > 1000) {
-                std::cout << "\nINFINITE LOOP DETECTED at PC=0x" << std::hex << pc << std::endl;
-                std::cout << "Breaking execution to prevent hang..." << std::endl;
-                break;
-            }
-        } else {
-            loop_detection_count = 0;
-            last_pc = pc;
-        }
-
-        // Handle ECALL specially since it needs syscall_num set
-        if (d.format == FORMAT_SYS && d.sys_op == SYSOP_ECALL) {
-            DecodedInstruction ecall_instr = d;
-            ecall_instr.syscall_num = d.imm;
-
-            ecalls.handle(ecall_instr, regs, mem, halted, gfx);
-            pc += 2;
-        } else {
-            // Store current PC for ALU execution
-            uint16_t next_pc = pc + 2;
-
-            // Execute instruction using ALU
-            alu.execute(d, regs, mem, next_pc, halted, ecalls, gfx);
-
-            // Update PC
-            pc = next_pc;
-        }
-
-        regs.setPC(pc);
-        instruction_count++;
-
-        // Mark graphics for update and render
-        gfx.markDirty();
-        gfx.update();
+    if (options.headless) {
+        std::cout << "Headless mode: no graphics window." << std::endl;
+    } else {
+        std::cout << "Graphics will be created by simulated ZX16 instructions." << std::endl;
+    }
 
-        // Show progress occasionally
-        if (instruction_count % 1000 == 0) {
-            std::cout << "Instructions executed: " << instruction_count << std::endl;
-        }
+    Simulator sim(regs, mem, gfx, ecalls, alu, predecode, options);
+    StopReason reason = sim.run();
 
-        // Safety check to prevent infinite loops
-        if (instruction_count > 100000) {
-            std::cout << "Stopping after 100000 instructions to prevent infinite loop." << std::endl;
-            break;
-        }
+    std::cout << "\nProgram execution completed." << std::endl;
+    std::cout << "Instructions executed: " << std::dec << sim.getInstructionCount() << std::endl;
 
-        // Small delay to prevent the CPU from running too fast (but not too slow)
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    if (options.headless) {
+        // Batch jobs get the ECALL 10 exit code (a0); anything else is a failure
+        return (reason == STOP_HALTED) ? (regs[6] & 0xFF) : 2;
     }
 
-    std::cout << "\nProgram execution completed." << std::endl;
-    std::cout << "Instructions executed: " << instruction_count << std::endl;
-
     // Keep graphics window open
     std::cout << "\nGraphics window will remain open. Close window to exit." << std::endl;
     while (gfx.isWindowOpen()) {
@@ -298,4 +265,4 @@ int main() {
     }
 
     return 0;
-}
\ No newline at end of file
+}
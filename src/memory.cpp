@@ -1,13 +1,74 @@
 #include "memory.h"
 #include <cstring>
 #include <stdexcept>
+#include <algorithm>
 
-Memory::Memory() {
+Memory::Memory() : mmioWritten(false) {
+    std::memset(pageFlags, 0, sizeof(pageFlags));
+    for (uint32_t page = MMIO_START >> MEMORY_PAGE_SHIFT; page < MEMORY_PAGE_COUNT; ++page) {
+        pageFlags[page] |= PAGE_MMIO;
+    }
     reset();
 }
 
 void Memory::reset() {
     std::memset(data, 0, MEMORY_SIZE);  // 64KB zeroed out
+
+    // Devices see the whole mapped range change
+    for (const MmioMapping& m : mmioMappings) {
+        m.device->onMmioWrite(m.first, 0, m.last - m.first + 1u);
+    }
+
+    // Everything that was decoded from the old image is stale now
+    for (uint32_t page = 0; page < MEMORY_PAGE_COUNT; ++page) {
+        if (pageFlags[page] & PAGE_CODE) {
+            notifyCodeWrite(page << MEMORY_PAGE_SHIFT, MEMORY_PAGE_SIZE);
+        }
+    }
+}
+
+void Memory::addCodeWriteListener(CodeWriteListener* listener) {
+    codeWriteListeners.push_back(listener);
+}
+
+void Memory::removeCodeWriteListener(CodeWriteListener* listener) {
+    codeWriteListeners.erase(std::remove(codeWriteListeners.begin(), codeWriteListeners.end(), listener),
+                             codeWriteListeners.end());
+}
+
+void Memory::notifyCodeWrite(uint32_t addr, uint32_t size) {
+    for (CodeWriteListener* listener : codeWriteListeners) {
+        listener->onCodeWrite(addr, size);
+    }
+}
+
+void Memory::mapDevice(uint16_t first, uint16_t last, MmioDevice* device) {
+    MmioMapping mapping = { first, last, device };
+    mmioMappings.push_back(mapping);
+}
+
+void Memory::unmapDevice(MmioDevice* device) {
+    mmioMappings.erase(std::remove_if(mmioMappings.begin(), mmioMappings.end(),
+                                      [device](const MmioMapping& m) { return m.device == device; }),
+                       mmioMappings.end());
+}
+
+void Memory::slowStore(uint16_t addr, uint32_t size) {
+    uint16_t last = static_cast<uint16_t>(addr + size - 1);
+
+    if ((pageFlags[addr >> MEMORY_PAGE_SHIFT] | pageFlags[last >> MEMORY_PAGE_SHIFT]) & PAGE_CODE) {
+        notifyCodeWrite(addr, size);
+    }
+
+    if (addr + size > MMIO_START) {
+        mmioWritten = true;
+        uint16_t value = (size == 1) ? data[addr] : load16(addr);
+        for (const MmioMapping& m : mmioMappings) {
+            if (addr <= m.last && last >= m.first) {
+                m.device->onMmioWrite(addr, value, size);
+            }
+        }
+    }
 }
 
 void Memory::checkBounds(uint32_t addr, uint32_t size) const {
@@ -24,6 +85,7 @@ uint8_t Memory::readByte(uint32_t addr) const {
 void Memory::writeByte(uint32_t addr, uint8_t val) {
     checkBounds(addr, 1);
     data[addr] = val;
+    trackWrite(addr, 1);
 }
 
 uint16_t Memory::readHalfWord(uint32_t addr) const {
@@ -42,41 +104,5 @@ void Memory::writeHalfWord(uint32_t addr, uint16_t val) {
     checkBounds(addr, 2);
     data[addr]     = static_cast<uint8_t>(val & 0xFF);
     data[addr + 1] = static_cast<uint8_t>((val >> 8) & 0xFF);
-}
-
-// ZX16-compatible aliases
-uint16_t Memory::load16(uint32_t addr) const {
-    return readHalfWord(addr);
-}
-
-uint8_t Memory::load8(uint32_t addr) const {
-    return readByte(addr);
-}
-
-// In memory.cpp - Add graphics update detection
-// In memory.cpp, store8() method, add graphics debugging:
-void Memory::store8(uint32_t addr, uint8_t val) {
-    checkBounds(addr, 1);
-    data[addr] = val;
-
-    // Debug ALL graphics memory writes
-    if (addr >= 0xF000 && addr <= 0xF12B) {
-        std::cout << "[ASSEMBLY GRAPHICS] Writing tile " << (int)val
-                  << " to (" << ((addr-0xF000)%20) << "," << ((addr-0xF000)/20)
-                  << ") at 0x" << std::hex << addr << std::dec << std::endl;
-    }
-}
-void Memory::store16(uint32_t addr, uint16_t val) {
-    if (addr % 2 != 0) {
-        throw AddressMisalignedException(addr, 2);
-    }
-    checkBounds(addr, 2);
-    data[addr]     = static_cast<uint8_t>(val & 0xFF);
-    data[addr + 1] = static_cast<uint8_t>((val >> 8) & 0xFF);
-
-    // Check if write is to graphics memory region
-    if (addr >= 0xF000 && addr <= 0xFFFF) {
-       // std::cout << "[GRAPHICS] Memory write to graphics region: 0x"
-         //         << std::hex << addr << " = 0x" << val << std::endl;
-    }
+    trackWrite(addr, 2);
 }
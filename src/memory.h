@@ -14,6 +14,19 @@
 #include <SFML/Graphics.hpp>
 const uint32_t MEMORY_SIZE = 65536; // 64KB address space
 
+// Page bookkeeping used to detect writes to cached code (256 pages of 256 bytes)
+const uint32_t MEMORY_PAGE_SHIFT = 8;
+const uint32_t MEMORY_PAGE_SIZE = 1u << MEMORY_PAGE_SHIFT;
+const uint32_t MEMORY_PAGE_COUNT = MEMORY_SIZE / MEMORY_PAGE_SIZE;
+
+// Memory-mapped I/O window (graphics tile map, tile data, palette)
+const uint32_t MMIO_START = 0xF000;
+
+enum MemoryPageFlags : uint8_t {
+    PAGE_CODE = 0x01,  // some cache holds decoded instructions from this page
+    PAGE_MMIO = 0x02   // 0xF000-0xFFFF: stores are dispatched to MMIO devices
+};
+
 // Custom exception classes
 class AddressOutOfBoundsException : public std::runtime_error {
 public:
@@ -28,18 +41,60 @@ public:
                            " (required alignment: " + std::to_string(alignment) + ")") {}
 };
 
+// Notified when a store lands on a page marked as code, so decoded copies
+// of the overwritten instructions can be dropped
+class CodeWriteListener {
+public:
+    virtual ~CodeWriteListener() {}
+    virtual void onCodeWrite(uint32_t addr, uint32_t size) = 0;
+};
+
+// Side effects of stores into the MMIO window. The bytes themselves still
+// live in Memory; a device only observes writes to the range it mapped.
+// value holds the stored data for 1- and 2-byte stores; reset() reports the
+// whole mapped range at once.
+class MmioDevice {
+public:
+    virtual ~MmioDevice() {}
+    virtual void onMmioWrite(uint16_t addr, uint16_t value, uint32_t size) = 0;
+};
+
 class Memory {
 private:
+    struct MmioMapping {
+        uint16_t first;
+        uint16_t last;
+        MmioDevice* device;
+    };
+
     uint8_t data[MEMORY_SIZE];
+    uint8_t pageFlags[MEMORY_PAGE_COUNT];
+    std::vector<CodeWriteListener*> codeWriteListeners;
+    std::vector<MmioMapping> mmioMappings;
+    bool mmioWritten;
 
     void checkBounds(uint32_t addr, uint32_t size) const;
 
+    void notifyCodeWrite(uint32_t addr, uint32_t size);
+
+    // Out of line: only reached for code pages and the MMIO window
+    void slowStore(uint16_t addr, uint32_t size);
+
+    // One flag test per store; plain RAM never leaves the inline path
+    void trackWrite(uint16_t addr, uint32_t size) {
+        if ((pageFlags[addr >> MEMORY_PAGE_SHIFT] |
+             pageFlags[static_cast<uint16_t>(addr + size - 1) >> MEMORY_PAGE_SHIFT]) & (PAGE_CODE | PAGE_MMIO)) {
+            slowStore(addr, size);
+        }
+    }
+
 public:
     Memory();
 
     void reset();
 
-    // Original method names (descriptive)
+    // Checked accessors: bounds (and alignment for halfwords) throw.
+    // Meant for loaders and tools that compute addresses wider than 16 bits.
     uint8_t readByte(uint32_t addr) const;
     void writeByte(uint32_t addr, uint8_t val);
 
@@ -49,12 +104,44 @@ public:
     uint16_t readWord(uint32_t addr) const;
     void writeWord(uint32_t addr, uint16_t val);
 
-    // Compatibility methods for main() function
-    uint16_t load16(uint32_t addr) const;
-    void store16(uint32_t addr, uint16_t val);
+    // Unchecked fast path for the execution core. A 16-bit address always
+    // fits in the 64KB array; halfword callers check alignment themselves
+    // (a misaligned access wraps instead of faulting). Little-endian.
+    uint8_t load8(uint16_t addr) const { return data[addr]; }
+    uint16_t load16(uint16_t addr) const {
+        return static_cast<uint16_t>(data[addr] | (data[static_cast<uint16_t>(addr + 1)] << 8));
+    }
+    void store8(uint16_t addr, uint8_t val) {
+        data[addr] = val;
+        trackWrite(addr, 1);
+    }
+    void store16(uint16_t addr, uint16_t val) {
+        data[addr] = static_cast<uint8_t>(val);
+        data[static_cast<uint16_t>(addr + 1)] = static_cast<uint8_t>(val >> 8);
+        trackWrite(addr, 2);
+    }
+
+    // Route stores to [first, last] (inside 0xF000-0xFFFF) to device
+    void mapDevice(uint16_t first, uint16_t last, MmioDevice* device);
+    void unmapDevice(MmioDevice* device);
+
+    // Code page tracking for decoded-instruction caches
+    void addCodeWriteListener(CodeWriteListener* listener);
+    void removeCodeWriteListener(CodeWriteListener* listener);
+    void markCodePage(uint32_t addr) { pageFlags[(addr >> MEMORY_PAGE_SHIFT) & (MEMORY_PAGE_COUNT - 1)] |= PAGE_CODE; }
+    bool isCodePage(uint32_t addr) const { return (pageFlags[(addr >> MEMORY_PAGE_SHIFT) & (MEMORY_PAGE_COUNT - 1)] & PAGE_CODE) != 0; }
+
+    // Raw storage for the native code generator. Writes through hostData()
+    // bypass code-page and MMIO tracking, so callers check hostPageFlags() first.
+    uint8_t* hostData() { return data; }
+    const uint8_t* hostPageFlags() const { return pageFlags; }
 
-    uint8_t load8(uint32_t addr) const;
-    void store8(uint32_t addr, uint8_t val);
+    // True if anything was stored to 0xF000-0xFFFF since the last call
+    bool consumeMmioWrite() {
+        bool written = mmioWritten;
+        mmioWritten = false;
+        return written;
+    }
 
     // uint32_t load32(uint32_t addr) const;
     // void store32(uint32_t addr, uint32_t val);
@@ -0,0 +1,47 @@
+#include "predecode.h"
+#include "decode_table.h"
+
+PredecodeCache::PredecodeCache(Memory& mem)
+    : memory(mem), fills(0), invalidations(0) {
+    PredecodedInstruction empty = {};
+    empty.op = OP_UNDECODED;
+    slots.assign(NUM_SLOTS, empty);
+    memory.addCodeWriteListener(this);
+}
+
+PredecodeCache::~PredecodeCache() {
+    memory.removeCodeWriteListener(this);
+}
+
+const PredecodedInstruction& PredecodeCache::fill(uint16_t pc) {
+    // The checked read throws on a misaligned PC, same as the uncached fetch did
+    uint16_t word = memory.readHalfWord(pc);
+
+    PredecodedInstruction& slot = slots[pc >> 1];
+    slot = lookupDecoded(word);
+    memory.markCodePage(pc);
+    fills++;
+    return slot;
+}
+
+void PredecodeCache::invalidate(uint32_t addr, uint32_t size) {
+    if (size == 0) {
+        return;
+    }
+    uint32_t first = addr >> 1;
+    uint32_t last = (addr + size - 1) >> 1;
+    for (uint32_t i = first; i <= last && i < NUM_SLOTS; ++i) {
+        if (slots[i].op != OP_UNDECODED) {
+            slots[i].op = OP_UNDECODED;
+            invalidations++;
+        }
+    }
+}
+
+void PredecodeCache::invalidateAll() {
+    invalidate(0, MEMORY_SIZE);
+}
+
+void PredecodeCache::onCodeWrite(uint32_t addr, uint32_t size) {
+    invalidate(addr, size);
+}
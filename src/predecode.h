@@ -0,0 +1,47 @@
+#ifndef PREDECODE_H
+#define PREDECODE_H
+
+#include <cstdint>
+#include <vector>
+#include "decoder.h"
+#include "memory.h"
+
+// Predecoded instruction cache covering the whole 64KB address space.
+// One slot per halfword (PC / 2), filled lazily on first fetch from the
+// decode table and dropped again when Memory reports a store to that address.
+class PredecodeCache : public CodeWriteListener {
+public:
+    static const uint32_t NUM_SLOTS = MEMORY_SIZE / 2;
+
+    explicit PredecodeCache(Memory& mem);
+    ~PredecodeCache();
+
+    // Hot path: one indexed load when the slot is already filled
+    const PredecodedInstruction& fetch(uint16_t pc) {
+        const PredecodedInstruction& slot = slots[pc >> 1];
+        if (slot.op != OP_UNDECODED && !(pc & 1)) {
+            return slot;
+        }
+        return fill(pc);
+    }
+
+    void invalidate(uint32_t addr, uint32_t size);
+    void invalidateAll();
+
+    void onCodeWrite(uint32_t addr, uint32_t size) override;
+
+    // Statistics
+    uint64_t getFillCount() const { return fills; }
+    uint64_t getInvalidationCount() const { return invalidations; }
+
+private:
+    const PredecodedInstruction& fill(uint16_t pc);
+
+    Memory& memory;
+    std::vector<PredecodedInstruction> slots;
+
+    uint64_t fills;
+    uint64_t invalidations;
+};
+
+#endif // PREDECODE_H
@@ -39,6 +39,13 @@ public:
 
     void set(int idx, uint16_t val);
 
+    // Unchecked access for the execution core; decoded register fields are always 3 bits
+    uint16_t getFast(uint8_t idx) const { return regs[idx & (NUM_REGISTERS - 1)]; }
+    void setFast(uint8_t idx, uint16_t val) { regs[idx & (NUM_REGISTERS - 1)] = val; }
+
+    // x0-x7 storage for the native code generator
+    uint16_t* data() { return regs.data(); }
+
     std::string getRegisterName(int idx) const;
     int getRegisterIndex(const std::string& name) const;
 
@@ -0,0 +1,195 @@
+#include "simulator.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+Simulator::Simulator(Registers& regs, Memory& mem, Graphics& gfx, Ecalls& ecalls,
+                     ALU& alu, PredecodeCache& predecode, const RunOptions& options)
+    : regs(regs), mem(mem), gfx(gfx), ecalls(ecalls), alu(alu), predecode(predecode),
+      blocks(mem, predecode),
+      options(options),
+      pc(regs.getPC()),
+      halted(false),
+      stopReason(STOP_NONE),
+      instructionCount(0),
+      sinceFrame(0),
+      loopDetectionCount(0),
+      lastPc(0xFFFF) {
+    if (this->options.frameInterval == 0) {
+        this->options.frameInterval = 1;
+    }
+    if (this->options.engine == ENGINE_JIT) {
+        if (jit.isAvailable()) {
+            blocks.setJit(&jit);
+        } else {
+            std::cout << "JIT not available on this host, using the block interpreter." << std::endl;
+            this->options.engine = ENGINE_BLOCKS;
+        }
+    }
+}
+
+StopReason Simulator::run() {
+    while (stopReason == STOP_NONE) {
+        if (!options.headless && !gfx.isWindowOpen()) {
+            stopReason = STOP_WINDOW_CLOSED;
+            break;
+        }
+        try {
+            // The first few instructions are traced one by one
+            if (options.engine != ENGINE_STEP && instructionCount >= options.traceFirst) {
+                runBlocks();
+            } else {
+                step();
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Execution error at PC=0x" << std::hex << pc << std::dec << ": " << e.what() << std::endl;
+            stopReason = STOP_FAULT;
+        }
+    }
+    return stopReason;
+}
+
+bool Simulator::step() {
+    if (halted) {
+        return false;
+    }
+
+    const PredecodedInstruction& p = predecode.fetch(pc);
+
+    // Show first instructions for debugging (NOP = ADD x0, x0 is skipped)
+    if (instructionCount < options.traceFirst && !(p.op == OP_ADD && p.rd == 0 && p.rs2 == 0)) {
+        std::string formatted = formatInstruction(decoder.decode(p.raw));
+        std::cout << std::hex << std::setw(4) << std::setfill('0') << pc << ": " << formatted << std::endl;
+    }
+
+    // Detect infinite loops
+    if (options.detectLoops) {
+        if (pc == lastPc) {
+            loopDetectionCount++;
+            if (loopDetectionCount > 1000) {
+                std::cout << "\nINFINITE LOOP DETECTED at PC=0x" << std::hex << pc << std::endl;
+                std::cout << "Breaking execution to prevent hang..." << std::endl;
+                stopReason = STOP_INFINITE_LOOP;
+                return false;
+            }
+        } else {
+            loopDetectionCount = 0;
+            lastPc = pc;
+        }
+    }
+
+    // Handle ECALL specially since it needs syscall_num set
+    if (p.op == OP_ECALL) {
+        DecodedInstruction ecall_instr;
+        ecall_instr.syscall_num = p.imm;
+
+        ecalls.handle(ecall_instr, regs, mem, halted, gfx);
+        pc += 2;
+    } else {
+        // ALU works with the already incremented PC
+        uint16_t next_pc = pc + 2;
+        alu.execute(p, regs, mem, next_pc, halted);
+        pc = next_pc;
+    }
+
+    regs.setPC(pc);
+    instructionCount++;
+
+    // Graphics and events are sampled, not run after every instruction
+    if (!options.headless) {
+        bool mmioWrite = options.frameOnMmioWrite && mem.consumeMmioWrite();
+        if (++sinceFrame >= options.frameInterval || mmioWrite) {
+            sampleFrame();
+        }
+    }
+
+    // Show progress occasionally
+    if (options.progressInterval != 0 && instructionCount % options.progressInterval == 0) {
+        std::cout << "Instructions executed: " << std::dec << instructionCount << std::endl;
+    }
+
+    if (halted) {
+        stopReason = STOP_HALTED;
+        return false;
+    }
+
+    // Safety check to prevent infinite loops
+    if (options.maxInstructions != 0 && instructionCount >= options.maxInstructions) {
+        std::cout << "Stopping after " << std::dec << options.maxInstructions
+                  << " instructions to prevent infinite loop." << std::endl;
+        stopReason = STOP_INSTRUCTION_LIMIT;
+        return false;
+    }
+
+    // Small delay to keep interactive programs watchable
+    if (options.stepDelayUs != 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(options.stepDelayUs));
+    }
+    return true;
+}
+
+bool Simulator::runBlocks() {
+    if (halted) {
+        return false;
+    }
+
+    // Never run past the next frame sample or the instruction limit
+    uint64_t budget = options.headless ? UINT64_MAX : (options.frameInterval - sinceFrame);
+    if (options.maxInstructions != 0) {
+        budget = std::min<uint64_t>(budget, options.maxInstructions - instructionCount);
+    }
+
+    ExecContext ctx = { regs, mem, pc, halted };
+    BlockRunResult result = { 0, false };
+    try {
+        blocks.run(ctx, budget, options.detectLoops ? 1000 : 0, result);
+    } catch (...) {
+        // Keep the count of what retired before the fault
+        instructionCount += result.executed;
+        throw;
+    }
+    if (result.executed == 0) {
+        // ECALL (or unknown SYS) at the block start
+        return step();
+    }
+
+    regs.setPC(pc);
+    instructionCount += result.executed;
+
+    if (result.infiniteLoop) {
+        std::cout << "\nINFINITE LOOP DETECTED at PC=0x" << std::hex << pc << std::endl;
+        std::cout << "Breaking execution to prevent hang..." << std::endl;
+        stopReason = STOP_INFINITE_LOOP;
+        return false;
+    }
+
+    if (!options.headless) {
+        sinceFrame += static_cast<uint32_t>(result.executed);
+        bool mmioWrite = options.frameOnMmioWrite && mem.consumeMmioWrite();
+        if (sinceFrame >= options.frameInterval || mmioWrite) {
+            sampleFrame();
+        }
+    }
+
+    if (halted) {
+        stopReason = STOP_HALTED;
+        return false;
+    }
+
+    if (options.maxInstructions != 0 && instructionCount >= options.maxInstructions) {
+        std::cout << "Stopping after " << std::dec << options.maxInstructions
+                  << " instructions to prevent infinite loop." << std::endl;
+        stopReason = STOP_INSTRUCTION_LIMIT;
+        return false;
+    }
+    return true;
+}
+
+void Simulator::sampleFrame() {
+    sinceFrame = 0;
+    gfx.markDirty();
+    gfx.update();
+}
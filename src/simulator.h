@@ -0,0 +1,92 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <cstdint>
+#include "alu.h"
+#include "predecode.h"
+#include "block_cache.h"
+#include "jit_x64.h"
+
+// Which execution path run() uses
+enum ExecutionEngine {
+    ENGINE_STEP,      // fetch/execute one instruction per loop iteration
+    ENGINE_BLOCKS,    // run chained basic blocks from the block cache
+    ENGINE_JIT        // as ENGINE_BLOCKS, hot blocks compiled to x86-64
+};
+
+// How the fetch/execute loop is paced against the SFML front end
+struct RunOptions {
+    bool headless = false;            // never open a window, never poll events
+    uint32_t frameInterval = 1;       // instructions between graphics/event samples
+    bool frameOnMmioWrite = false;    // also sample after each store to 0xF000-0xFFFF
+    uint32_t stepDelayUs = 100;       // sleep after every instruction (0 = full speed)
+    uint64_t maxInstructions = 100000;// 0 = no limit
+    uint32_t progressInterval = 1000; // "Instructions executed" lines (0 = off)
+    uint32_t traceFirst = 20;         // disassemble the first N non-NOP instructions
+    bool detectLoops = true;          // stop after 1000 fetches of the same PC
+    ExecutionEngine engine = ENGINE_STEP;
+
+    // Full host speed: no per-step delay, graphics sampled every N instructions
+    void setTurbo(uint32_t interval) {
+        stepDelayUs = 0;
+        frameInterval = interval;
+        progressInterval = 0;
+        engine = ENGINE_BLOCKS;
+    }
+};
+
+enum StopReason {
+    STOP_NONE,
+    STOP_HALTED,            // ECALL 10 or a fatal execution error
+    STOP_WINDOW_CLOSED,
+    STOP_INSTRUCTION_LIMIT,
+    STOP_INFINITE_LOOP,
+    STOP_FAULT              // memory exception (e.g. misaligned fetch)
+};
+
+class Simulator {
+public:
+    Simulator(Registers& regs, Memory& mem, Graphics& gfx, Ecalls& ecalls,
+              ALU& alu, PredecodeCache& predecode, const RunOptions& options);
+
+    // Run until the program halts or a RunOptions limit stops it
+    StopReason run();
+
+    // Execute exactly one instruction; returns false once halted
+    bool step();
+
+    // Execute chained basic blocks up to the next frame sample or limit;
+    // falls back to step() for ECALLs
+    bool runBlocks();
+
+    uint64_t getInstructionCount() const { return instructionCount; }
+    uint16_t getPC() const { return pc; }
+    bool isHalted() const { return halted; }
+    StopReason getStopReason() const { return stopReason; }
+    const BlockCache& getBlockCache() const { return blocks; }
+    const JitCompiler& getJit() const { return jit; }
+
+private:
+    void sampleFrame();
+
+    Registers& regs;
+    Memory& mem;
+    Graphics& gfx;
+    Ecalls& ecalls;
+    ALU& alu;
+    PredecodeCache& predecode;
+    BlockCache blocks;
+    JitCompiler jit;
+    Decoder decoder;          // only used for the debug disassembly
+    RunOptions options;
+
+    uint16_t pc;
+    bool halted;
+    StopReason stopReason;
+    uint64_t instructionCount;
+    uint32_t sinceFrame;
+    uint32_t loopDetectionCount;
+    uint16_t lastPc;
+};
+
+#endif // SIMULATOR_H
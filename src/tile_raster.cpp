@@ -0,0 +1,170 @@
+#include "tile_raster.h"
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ZX16_RASTER_X86 1
+#include <immintrin.h>
+#define ZX16_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define ZX16_RASTER_X86 1
+#include <immintrin.h>
+#include <intrin.h>
+#define ZX16_TARGET(isa)
+#else
+#define ZX16_RASTER_X86 0
+#endif
+
+static const int TILE_PIXELS = 16;
+static const int TILE_ROW_BYTES = 8;    // packed bytes per tile row
+
+static uint32_t makePixel(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    uint8_t bytes[4] = { r, g, b, a };
+    uint32_t pixel;
+    std::memcpy(&pixel, bytes, 4);
+    return pixel;
+}
+
+namespace {
+// All 256 RGB332 values expanded once: bits 7-5 red, 4-2 green, 1-0 blue
+struct Rgb332Table {
+    uint32_t entries[256];
+
+    Rgb332Table() {
+        for (int v = 0; v < 256; ++v) {
+            uint8_t red8   = static_cast<uint8_t>((((v >> 5) & 0x07) * 255) / 7);
+            uint8_t green8 = static_cast<uint8_t>((((v >> 2) & 0x07) * 255) / 7);
+            uint8_t blue8  = static_cast<uint8_t>(((v & 0x03) * 255) / 3);
+            entries[v] = makePixel(red8, green8, blue8, 255);
+        }
+    }
+};
+const Rgb332Table rgb332Table;
+}
+
+uint32_t rgb332ToPixel(uint8_t value) {
+    return rgb332Table.entries[value];
+}
+
+void setPaletteEntry(TileLookup& lookup, int index, uint8_t rgb332) {
+    lookup.palette[index & 0x0F] = rgb332Table.entries[rgb332];
+}
+
+void rebuildPairs(TileLookup& lookup) {
+    for (int b = 0; b < 256; ++b) {
+        uint32_t two[2] = { lookup.palette[b & 0x0F], lookup.palette[b >> 4] };
+        std::memcpy(&lookup.pairs[b], two, 8);
+    }
+}
+
+void clearTile(uint8_t* dst, size_t stride) {
+    uint32_t black = makePixel(0, 0, 0, 255);
+    for (int row = 0; row < TILE_PIXELS; ++row) {
+        uint8_t* out = dst + row * stride;
+        for (int px = 0; px < TILE_PIXELS; ++px) {
+            std::memcpy(out + px * 4, &black, 4);
+        }
+    }
+}
+
+static void rasterTileScalar(const TileLookup& lookup, const uint8_t* packed, uint8_t* dst, size_t stride) {
+    for (int row = 0; row < TILE_PIXELS; ++row) {
+        const uint8_t* src = packed + row * TILE_ROW_BYTES;
+        uint8_t* out = dst + row * stride;
+        for (int i = 0; i < TILE_ROW_BYTES; ++i) {
+            std::memcpy(out + i * 8, &lookup.pairs[src[i]], 8);
+        }
+    }
+}
+
+#if ZX16_RASTER_X86
+
+ZX16_TARGET("sse2")
+static void rasterTileSse2(const TileLookup& lookup, const uint8_t* packed, uint8_t* dst, size_t stride) {
+    for (int row = 0; row < TILE_PIXELS; ++row) {
+        const uint8_t* src = packed + row * TILE_ROW_BYTES;
+        uint8_t* out = dst + row * stride;
+        for (int i = 0; i < TILE_ROW_BYTES; i += 2) {
+            __m128i four = _mm_set_epi64x(static_cast<long long>(lookup.pairs[src[i + 1]]),
+                                          static_cast<long long>(lookup.pairs[src[i]]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 8), four);
+        }
+    }
+}
+
+// Each half row: 4 packed bytes -> 8 nibble indices -> 8 pixels. The 16
+// palette entries sit in two registers; bit 3 of the index picks one.
+ZX16_TARGET("avx2")
+static void rasterTileAvx2(const TileLookup& lookup, const uint8_t* packed, uint8_t* dst, size_t stride) {
+    const __m256i palLo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&lookup.palette[0]));
+    const __m256i palHi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&lookup.palette[8]));
+    const __m256i spread = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i shifts = _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4);
+    const __m256i nibble = _mm256_set1_epi32(0x0F);
+    const __m256i seven = _mm256_set1_epi32(7);
+
+    for (int row = 0; row < TILE_PIXELS; ++row) {
+        const uint8_t* src = packed + row * TILE_ROW_BYTES;
+        uint8_t* out = dst + row * stride;
+        for (int half = 0; half < 2; ++half) {
+            int32_t four;
+            std::memcpy(&four, src + half * 4, 4);
+            __m256i bytes = _mm256_cvtepu8_epi32(_mm_cvtsi32_si128(four));
+            __m256i idx = _mm256_and_si256(_mm256_srlv_epi32(_mm256_permutevar8x32_epi32(bytes, spread), shifts), nibble);
+            __m256i lo = _mm256_permutevar8x32_epi32(palLo, idx);
+            __m256i hi = _mm256_permutevar8x32_epi32(palHi, idx);
+            __m256i pixels = _mm256_blendv_epi8(lo, hi, _mm256_cmpgt_epi32(idx, seven));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + half * 32), pixels);
+        }
+    }
+}
+
+static bool cpuHasAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // ZX16_RASTER_X86
+
+RasterPath detectRasterPath() {
+#if ZX16_RASTER_X86
+    return cpuHasAvx2() ? RASTER_AVX2 : RASTER_SSE2;
+#else
+    return RASTER_SCALAR;
+#endif
+}
+
+const char* rasterPathName(RasterPath path) {
+    switch (path) {
+        case RASTER_SSE2: return "SSE2";
+        case RASTER_AVX2: return "AVX2";
+        default:          return "scalar";
+    }
+}
+
+void rasterTile(RasterPath path, const TileLookup& lookup, const uint8_t* packed, uint8_t* dst, size_t stride) {
+#if ZX16_RASTER_X86
+    if (path == RASTER_AVX2) {
+        rasterTileAvx2(lookup, packed, dst, stride);
+        return;
+    }
+    if (path == RASTER_SSE2) {
+        rasterTileSse2(lookup, packed, dst, stride);
+        return;
+    }
+#else
+    (void)path;
+#endif
+    rasterTileScalar(lookup, packed, dst, stride);
+}
@@ -0,0 +1,38 @@
+#ifndef TILE_RASTER_H
+#define TILE_RASTER_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Lookup tables for turning 4bpp tile bytes into RGBA pixels.
+// Pixels are stored in memory order R, G, B, A (what sf::Texture expects).
+struct TileLookup {
+    uint32_t palette[16];    // palette entry -> one pixel
+    uint64_t pairs[256];     // packed byte -> two pixels, low nibble (even pixel) first
+};
+
+enum RasterPath {
+    RASTER_SCALAR,    // one 64-bit store per packed byte
+    RASTER_SSE2,      // two pair lookups per 128-bit store
+    RASTER_AVX2       // palette held in registers, 8 pixels per permute
+};
+
+// RGB332 palette byte -> RGBA pixel (precomputed, no divisions)
+uint32_t rgb332ToPixel(uint8_t value);
+
+// Refresh palette[index] from an RGB332 byte; call rebuildPairs() afterwards
+void setPaletteEntry(TileLookup& lookup, int index, uint8_t rgb332);
+void rebuildPairs(TileLookup& lookup);
+
+// Best path this CPU supports
+RasterPath detectRasterPath();
+const char* rasterPathName(RasterPath path);
+
+// Draw one 16x16 tile from 128 packed bytes (8 per row). stride is the
+// destination row pitch in bytes. Every path writes identical bytes.
+void rasterTile(RasterPath path, const TileLookup& lookup, const uint8_t* packed, uint8_t* dst, size_t stride);
+
+// Fill a 16x16 area with opaque black (map entries >= 16)
+void clearTile(uint8_t* dst, size_t stride);
+
+#endif // TILE_RASTER_H
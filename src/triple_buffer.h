@@ -0,0 +1,42 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Lock-free hand-off of whole values from one producer thread to one
+// consumer thread. The producer fills writeBuffer() and publish()es it; the
+// consumer acquire()s the newest published value and reads readBuffer()
+// until its next acquire(). Neither side waits, and intermediate values
+// may be skipped.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : back(0), front(1), middle(2) {}
+
+    // Producer
+    T& writeBuffer() { return slots[back]; }
+    void publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Consumer; false if nothing new was published since the last call
+    bool acquire() {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    const T& readBuffer() const { return slots[front]; }
+
+private:
+    static const int INDEX = 0x3;
+    static const int FRESH = 0x4;
+
+    T slots[3];
+    int back;                  // producer-owned slot
+    int front;                 // consumer-owned slot
+    std::atomic<int> middle;   // last published slot, FRESH until consumed
+};
+
+#endif // TRIPLE_BUFFER_H
@@ -0,0 +1,37 @@
+// Build-time generator for the ZX16 decode table.
+// Runs Decoder::predecode on every 16-bit word and writes the results as a
+// C++ initializer list that src/decode_table.cpp compiles in.
+//
+// Usage: gen_decode_table <output.inc>
+
+#include <cstdio>
+#include "decoder.h"
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "Usage: %s <output.inc>\n", argv[0]);
+        return 1;
+    }
+
+    FILE* out = std::fopen(argv[1], "w");
+    if (!out) {
+        std::perror(argv[1]);
+        return 1;
+    }
+
+    std::fprintf(out, "// Generated by gen_decode_table from Decoder::decode - do not edit\n");
+    std::fprintf(out, "// { raw, imm, op, rd, rs1, rs2 }\n");
+
+    Decoder decoder;
+    for (uint32_t word = 0; word < 0x10000; ++word) {
+        PredecodedInstruction p = decoder.predecode(static_cast<uint16_t>(word));
+        std::fprintf(out, "{0x%04X, %d, %u, %u, %u, %u},\n",
+                     p.raw, p.imm, p.op, p.rd, p.rs1, p.rs2);
+    }
+
+    if (std::fclose(out) != 0) {
+        std::perror(argv[1]);
+        return 1;
+    }
+    return 0;
+}